@@ -0,0 +1,421 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 7:03:52pm
+    Author:  Johan Bremin
+
+    Microbenchmarks for processBlock, the DelayLine kernels and parameter
+    smoothing. Every case reports the time per sample and the real-time
+    factor, which is how many times faster than real time it runs.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+
+// Keeps the optimizer from removing the work that is being measured.
+static volatile float sink = 0.0f;
+
+struct BenchmarkSettings
+{
+    double seconds = 2.0;         // length of audio rendered per case
+    juce::String filter;          // only run cases whose name contains this
+};
+
+static void report(const juce::String& name, double sampleRate, juce::int64 numSamples,
+                   double elapsedSeconds)
+{
+    double nsPerSample = elapsedSeconds * 1e9 / double(numSamples);
+    double realtimeFactor = (double(numSamples) / sampleRate) / elapsedSeconds;
+    
+    std::printf("%-64s %10.2f ns/sample %10.1fx realtime\n",
+                name.toRawUTF8(), nsPerSample, realtimeFactor);
+    std::fflush(stdout);
+}
+
+// Runs the case once to warm up the caches, then times it for the requested
+// amount of audio. The function processes numSamples samples per call.
+template<typename Function>
+static void measure(const juce::String& name, const BenchmarkSettings& settings,
+                    double sampleRate, int numSamples, Function&& function)
+{
+    if (settings.filter.isNotEmpty() && !name.contains(settings.filter)) { return; }
+    
+    auto total = juce::int64(settings.seconds * sampleRate);
+    auto numCalls = std::max(juce::int64(1), total / numSamples);
+    
+    for (juce::int64 i = 0; i < std::min(numCalls, juce::int64(16)); ++i) {
+        function();
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    for (juce::int64 i = 0; i < numCalls; ++i) {
+        function();
+    }
+    auto end = std::chrono::steady_clock::now();
+    
+    double elapsed = std::chrono::duration<double>(end - start).count();
+    report(name, sampleRate, numCalls * numSamples, elapsed);
+}
+
+//==============================================================================
+struct Layout
+{
+    const char* name;
+    juce::AudioChannelSet input;
+    juce::AudioChannelSet output;
+};
+
+// Moves the automatable parameters along slow sine waves, one step per
+// block, the way a host applies automation between processBlock calls.
+class Automation
+{
+public:
+    explicit Automation(juce::AudioProcessorValueTreeState& apvts)
+    {
+        for (const auto& id : { gainParamID, delayTimeParamID, mixParamID, feedbackParamID,
+                                stereoParamID, lowCutParamID, highCutParamID }) {
+            params.push_back(apvts.getParameter(id.getParamID()));
+        }
+    }
+    
+    void advance(int numSamples, double sampleRate) noexcept
+    {
+        phase += double(numSamples) / sampleRate * 0.5 * juce::MathConstants<double>::twoPi;
+        for (size_t i = 0; i < params.size(); ++i) {
+            double offset = double(i) * 0.9;
+            params[i]->setValue(float(0.5 + 0.4 * std::sin(phase + offset)));
+        }
+    }
+    
+private:
+    std::vector<juce::RangedAudioParameter*> params;
+    double phase = 0.0;
+};
+
+static void benchmarkProcessBlock(const BenchmarkSettings& settings,
+                                  const std::vector<double>& sampleRates,
+                                  const std::vector<int>& blockSizes)
+{
+    const Layout layouts[] = {
+        { "mono->mono", juce::AudioChannelSet::mono(), juce::AudioChannelSet::mono() },
+        { "mono->stereo", juce::AudioChannelSet::mono(), juce::AudioChannelSet::stereo() },
+        { "stereo->stereo", juce::AudioChannelSet::stereo(), juce::AudioChannelSet::stereo() },
+        { "quad", juce::AudioChannelSet::quadraphonic(), juce::AudioChannelSet::quadraphonic() },
+        { "7.1.4", juce::AudioChannelSet::create7point1point4(), juce::AudioChannelSet::create7point1point4() },
+        { "ambisonic 3", juce::AudioChannelSet::ambisonic(3), juce::AudioChannelSet::ambisonic(3) },
+    };
+    
+    for (double sampleRate : sampleRates) {
+        for (int blockSize : blockSizes) {
+            for (const auto& layout : layouts) {
+                for (bool tempoSync : { false, true }) {
+                    for (bool automated : { false, true }) {
+                        juce::String name;
+                        name << "processBlock " << int(sampleRate) << " Hz, block " << blockSize
+                             << ", " << layout.name << (tempoSync ? ", sync" : ", free")
+                             << (automated ? ", automated" : ", static");
+                        
+                        if (settings.filter.isNotEmpty() && !name.contains(settings.filter)) {
+                            continue;
+                        }
+                        
+                        DelayDSPAudioProcessor processor;
+                        
+                        juce::AudioProcessor::BusesLayout busesLayout;
+                        busesLayout.inputBuses.add(layout.input);
+                        busesLayout.outputBuses.add(layout.output);
+                        processor.setBusesLayout(busesLayout);
+                        
+                        processor.apvts.getParameter(tempoSyncParamID.getParamID())
+                            ->setValue(tempoSync ? 1.0f : 0.0f);
+                        
+                        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+                        processor.prepareToPlay(sampleRate, blockSize);
+                        
+                        int numChannels = std::max(layout.input.size(), layout.output.size());
+                        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+                        juce::MidiBuffer midi;
+                        juce::Random random(1234);
+                        Automation automation(processor.apvts);
+                        
+                        measure(name, settings, sampleRate, blockSize, [&] {
+                            // fresh input every block, like a real signal
+                            for (int ch = 0; ch < layout.input.size(); ++ch) {
+                                float* data = buffer.getWritePointer(ch);
+                                for (int i = 0; i < blockSize; ++i) {
+                                    data[i] = random.nextFloat() * 0.5f - 0.25f;
+                                }
+                            }
+                            if (automated) {
+                                automation.advance(blockSize, sampleRate);
+                            }
+                            processor.processBlock(buffer, midi);
+                            sink = sink + buffer.getSample(0, 0);
+                        });
+                        
+                        processor.releaseResources();
+                    }
+                }
+            }
+        }
+    }
+}
+
+// The same stereo instance with the feedback saturation off and on, to see
+// what the oversampling costs.
+static void benchmarkSaturation(const BenchmarkSettings& settings)
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    
+    const std::pair<const char*, SaturationMode> modes[] = {
+        { "off", SaturationMode::off },
+        { "2x", SaturationMode::oversample2x },
+        { "4x", SaturationMode::oversample4x },
+    };
+    
+    for (const auto& [modeName, mode] : modes) {
+        juce::String name;
+        name << "processBlock saturation " << modeName << ", " << int(sampleRate)
+             << " Hz, block " << blockSize << ", stereo->stereo";
+        
+        DelayDSPAudioProcessor processor;
+        
+        auto setParameter = [&](const juce::ParameterID& id, float value) {
+            auto* parameter = processor.apvts.getParameter(id.getParamID());
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        };
+        setParameter(saturationParamID, float(mode));
+        setParameter(driveParamID, 12.0f);
+        setParameter(feedbackParamID, 80.0f);
+        
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+        
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(1234);
+        
+        measure(name, settings, sampleRate, blockSize, [&] {
+            for (int ch = 0; ch < 2; ++ch) {
+                float* data = buffer.getWritePointer(ch);
+                for (int i = 0; i < blockSize; ++i) {
+                    data[i] = random.nextFloat() * 0.5f - 0.25f;
+                }
+            }
+            processor.processBlock(buffer, midi);
+            sink = sink + buffer.getSample(0, 0);
+        });
+        
+        processor.releaseResources();
+    }
+}
+
+// The same stereo instance in single and double precision.
+static void benchmarkPrecision(const BenchmarkSettings& settings)
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    
+    for (bool doublePrecision : { false, true }) {
+        juce::String name;
+        name << "processBlock " << (doublePrecision ? "double" : "float") << ", "
+             << int(sampleRate) << " Hz, block " << blockSize << ", stereo->stereo";
+        
+        if (settings.filter.isNotEmpty() && !name.contains(settings.filter)) {
+            continue;
+        }
+        
+        DelayDSPAudioProcessor processor;
+        processor.setProcessingPrecision(doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                         : juce::AudioProcessor::singlePrecision);
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+        
+        juce::AudioBuffer<float> floatBuffer(2, blockSize);
+        juce::AudioBuffer<double> doubleBuffer(2, blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(1234);
+        
+        auto processBuffer = [&](auto& buffer) {
+            for (int ch = 0; ch < 2; ++ch) {
+                auto* data = buffer.getWritePointer(ch);
+                for (int i = 0; i < blockSize; ++i) {
+                    data[i] = random.nextFloat() * 0.5f - 0.25f;
+                }
+            }
+            processor.processBlock(buffer, midi);
+            sink = sink + float(buffer.getSample(0, 0));
+        };
+        
+        measure(name, settings, sampleRate, blockSize, [&] {
+            if (doublePrecision) {
+                processBuffer(doubleBuffer);
+            } else {
+                processBuffer(floatBuffer);
+            }
+        });
+        
+        processor.releaseResources();
+    }
+}
+
+//==============================================================================
+template<typename SampleType, template<typename> class Interpolator>
+static void benchmarkDelayLine(const BenchmarkSettings& settings, const char* interpolatorName,
+                               DelayLineStorage storage = DelayLineStorage::full)
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = DelayLine<SampleType>::maxBlockSize;
+    
+    for (int numChannels : { 1, 2, 8, 16 }) {
+        for (bool modulated : { false, true }) {
+            juce::String suffix;
+            suffix << interpolatorName << ", " << numChannels << " ch"
+                   << (modulated ? ", modulated" : ", fixed");
+            if (std::is_same_v<SampleType, double>) {
+                suffix << ", double";
+            }
+            if (storage == DelayLineStorage::half) {
+                suffix << ", half";
+            }
+            
+            int maxDelayInSamples = int(Parameters::maxDelayTime / 1000.0 * sampleRate);
+            MemoryArena memory;
+            memory.reserve(DelayLine<SampleType>::getMemorySize(maxDelayInSamples, numChannels, storage));
+            
+            DelayLine<SampleType> delayLine;
+            delayLine.setMaximumDelayInSamples(memory, maxDelayInSamples, numChannels, storage);
+            delayLine.reset();
+            
+            Interpolator<SampleType> interpolator;
+            
+            constexpr int maxValues = blockSize * DelayLine<SampleType>::maxChannels;
+            SampleType input[maxValues];
+            SampleType output[maxValues];
+            float delays[blockSize];
+            double phase = 0.0;
+            
+            auto fillDelays = [&] {
+                for (int i = 0; i < blockSize; ++i) {
+                    delays[i] = 12000.0f;
+                    if (modulated) {
+                        phase += 0.0001;
+                        delays[i] += 200.0f * float(std::sin(phase));
+                    }
+                }
+            };
+            
+            for (int i = 0; i < maxValues; ++i) {
+                input[i] = SampleType(i) / SampleType(maxValues) - SampleType(0.5);
+            }
+            
+            measure("DelayLine write/read " + suffix, settings, sampleRate, blockSize, [&] {
+                fillDelays();
+                for (int i = 0; i < blockSize; ++i) {
+                    delayLine.write(input + i * numChannels);
+                    for (int ch = 0; ch < numChannels; ++ch) {
+                        output[i * numChannels + ch] = delayLine.read(ch, delays[i], interpolator);
+                    }
+                }
+                sink = sink + float(output[0]);
+            });
+            
+            measure("DelayLine writeBlock/readBlock " + suffix, settings, sampleRate, blockSize, [&] {
+                fillDelays();
+                delayLine.readBlock(delays, output, blockSize, interpolator);
+                delayLine.writeBlock(input, blockSize);
+                sink = sink + float(output[0]);
+            });
+        }
+    }
+}
+
+//==============================================================================
+static void benchmarkSmoothen(const BenchmarkSettings& settings)
+{
+    constexpr double sampleRate = 48000.0;
+    
+    for (int blockSize : { 1, 8, 32 }) {
+        for (bool automated : { false, true }) {
+            juce::String name;
+            name << "Parameters::smoothen block " << blockSize
+                 << (automated ? ", automated" : ", static");
+            
+            DelayDSPAudioProcessor processor;
+            processor.prepareToPlay(sampleRate, blockSize);
+            Automation automation(processor.apvts);
+            auto& params = processor.params;
+            
+            // A host block of 512 samples, smoothed in blocks of blockSize.
+            constexpr int hostBlockSize = 512;
+            
+            measure(name, settings, sampleRate, hostBlockSize, [&] {
+                if (automated) {
+                    automation.advance(hostBlockSize, sampleRate);
+                }
+                params.update();
+                for (int offset = 0; offset < hostBlockSize; offset += blockSize) {
+                    params.smoothen(blockSize);
+                    sink = sink + params.gain[0] + params.delayTime[0] + params.lowCut[0];
+                }
+            });
+        }
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // APVTS needs the message manager, even though its loop never runs here.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    BenchmarkSettings settings;
+    bool quick = false;
+    
+    for (int i = 1; i < argc; ++i) {
+        juce::String arg(argv[i]);
+        if (arg == "--quick") {
+            quick = true;
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            settings.seconds = std::max(0.01, juce::String(argv[++i]).getDoubleValue());
+        } else if (arg == "--filter" && i + 1 < argc) {
+            settings.filter = argv[++i];
+        } else {
+            std::printf("Usage: DelayDSPBenchmarks [--quick] [--seconds <n>] [--filter <text>]\n");
+            return 1;
+        }
+    }
+    
+    std::vector<double> sampleRates { 44100.0, 48000.0, 96000.0, 192000.0 };
+    std::vector<int> blockSizes { 1, 16, 64, 256, 1024, 4096 };
+    
+    if (quick) {
+        sampleRates = { 48000.0 };
+        blockSizes = { 64, 512 };
+    }
+    
+    benchmarkProcessBlock(settings, sampleRates, blockSizes);
+    benchmarkSaturation(settings);
+    benchmarkPrecision(settings);
+    
+    benchmarkDelayLine<float, NoInterpolation>(settings, "integer");
+    benchmarkDelayLine<float, LinearInterpolation>(settings, "linear");
+    benchmarkDelayLine<float, HermiteInterpolation>(settings, "hermite");
+    benchmarkDelayLine<float, LagrangeInterpolation>(settings, "lagrange");
+    benchmarkDelayLine<float, ThiranInterpolation>(settings, "allpass");
+    benchmarkDelayLine<float, SincInterpolation>(settings, "sinc");
+    
+    benchmarkDelayLine<double, HermiteInterpolation>(settings, "hermite");
+    benchmarkDelayLine<double, SincInterpolation>(settings, "sinc");
+    
+    benchmarkDelayLine<float, HermiteInterpolation>(settings, "hermite", DelayLineStorage::half);
+    benchmarkDelayLine<float, SincInterpolation>(settings, "sinc", DelayLineStorage::half);
+    
+    benchmarkSmoothen(settings);
+    
+    return 0;
+}
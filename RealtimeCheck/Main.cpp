@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 9:34:06pm
+    Author:  Johan Bremin
+
+    Plays host: prepares the processor at random sample rates, block sizes
+    and channel layouts, and calls processBlock with random automation.
+    Everything that happens inside processBlock runs under a real-time check.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+#include "RealtimeCheck.h"
+
+#include <thread>
+
+class HostPlayHead : public juce::AudioPlayHead
+{
+public:
+    juce::Optional<PositionInfo> getPosition() const override
+    {
+        PositionInfo info;
+        info.setBpm(bpm);
+        info.setTimeInSamples(samplePosition);
+        info.setIsPlaying(isPlaying);
+        return info;
+    }
+    
+    double bpm = 120.0;
+    juce::int64 samplePosition = 0;
+    bool isPlaying = true;
+};
+
+static juce::AudioProcessor::BusesLayout randomLayout(juce::Random& random)
+{
+    const auto mono = juce::AudioChannelSet::mono();
+    const auto stereo = juce::AudioChannelSet::stereo();
+    
+    const juce::AudioChannelSet multichannel[] = {
+        juce::AudioChannelSet::quadraphonic(),
+        juce::AudioChannelSet::create5point1(),
+        juce::AudioChannelSet::create7point1point4(),
+        juce::AudioChannelSet::ambisonic(3),
+    };
+    
+    juce::AudioProcessor::BusesLayout layout;
+    switch (random.nextInt(4)) {
+        case 0:
+            layout.inputBuses.add(mono);
+            layout.outputBuses.add(mono);
+            break;
+        case 1:
+            layout.inputBuses.add(mono);
+            layout.outputBuses.add(stereo);
+            break;
+        case 2:
+            layout.inputBuses.add(stereo);
+            layout.outputBuses.add(stereo);
+            break;
+        default: {
+            const auto& channelSet = multichannel[random.nextInt(int(std::size(multichannel)))];
+            layout.inputBuses.add(channelSet);
+            layout.outputBuses.add(channelSet);
+            break;
+        }
+    }
+    return layout;
+}
+
+// Runs on the audio thread, with the editor open on the message thread.
+static juce::int64 playRounds(DelayDSPAudioProcessor& processor, HostPlayHead& playHead,
+                              juce::Random& random, int numRounds)
+{
+    const double sampleRates[] = { 22050.0, 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    const int blockSizes[] = { 1, 7, 32, 64, 128, 441, 512, 1024, 4096 };
+    
+    auto parameters = processor.getParameters();
+    
+    // JUCE's slider and button attachments post a message to the message
+    // thread the first time their parameter changes on another thread, and
+    // no more until it has been delivered. The message loop doesn't run
+    // here, so posting them once, outside the check, keeps the attachments
+    // quiet for the rest of the run. The editor's own listeners stay checked.
+    for (auto* parameter : parameters) {
+        parameter->sendValueChangedMessageToListeners(parameter->getValue());
+    }
+    
+    juce::AudioBuffer<float> buffer;
+    juce::AudioBuffer<double> doubleBuffer;
+    juce::MidiBuffer midi;
+    juce::MemoryBlock state;
+    juce::int64 numBlocks = 0;
+    
+    for (int round = 0; round < numRounds; ++round) {
+        double sampleRate = sampleRates[random.nextInt(juce::numElementsInArray(sampleRates))];
+        int maxBlockSize = blockSizes[random.nextInt(juce::numElementsInArray(blockSizes))];
+        
+        // Hosts release the processor before changing the layout or the
+        // precision, and often prepare it again without releasing it when
+        // only the rate changes.
+        if (random.nextBool()) {
+            processor.releaseResources();
+            processor.setBusesLayout(randomLayout(random));
+            processor.setProcessingPrecision(random.nextBool() ? juce::AudioProcessor::doublePrecision
+                                                               : juce::AudioProcessor::singlePrecision);
+        }
+        
+        processor.setRateAndBufferSizeDetails(sampleRate, maxBlockSize);
+        processor.prepareToPlay(sampleRate, maxBlockSize);
+        
+        int numChannels = std::max(processor.getTotalNumInputChannels(),
+                                   processor.getTotalNumOutputChannels());
+        buffer.setSize(numChannels, maxBlockSize);
+        doubleBuffer.setSize(numChannels, maxBlockSize);
+        
+        // about half a second of audio per round
+        int remaining = int(sampleRate * 0.5);
+        
+        while (remaining > 0) {
+            // Hosts may pass fewer samples than announced, even none.
+            int numSamples = std::min(random.nextInt(maxBlockSize + 1), remaining);
+            remaining -= std::max(numSamples, 1);
+            
+            for (int ch = 0; ch < numChannels; ++ch) {
+                float* data = buffer.getWritePointer(ch);
+                double* doubleData = doubleBuffer.getWritePointer(ch);
+                for (int i = 0; i < numSamples; ++i) {
+                    data[i] = (random.nextFloat() * 2.0f - 1.0f) * 0.1f;
+                    doubleData[i] = double(data[i]);
+                }
+            }
+            
+            if (random.nextInt(50) == 0) {
+                playHead.bpm = 40.0 + random.nextDouble() * 200.0;
+            }
+            if (random.nextInt(200) == 0) {
+                playHead.isPlaying = !playHead.isPlaying;
+            }
+            
+            // A preset being loaded between blocks. Hosts do that on the
+            // message thread, which is busy waiting for this one here.
+            if (random.nextInt(500) == 0) {
+                processor.getStateInformation(state);
+                processor.setStateInformation(state.getData(), int(state.getSize()));
+            }
+            
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+            juce::AudioBuffer<double> doubleBlock(doubleBuffer.getArrayOfWritePointers(),
+                                                  numChannels, numSamples);
+            
+            {
+                ScopedRealtimeCheck check;
+                
+                // Plug-in wrappers apply automation on the audio thread, right
+                // before calling processBlock, and tell the listeners. Among
+                // them are the editor's, which must not post messages.
+                int numChanges = random.nextInt(4);
+                for (int i = 0; i < numChanges; ++i) {
+                    auto* parameter = parameters[random.nextInt(parameters.size())];
+                    float value = random.nextFloat();
+                    parameter->setValue(value);
+                    
+                    ScopedAllowLocks allowLocks;
+                    parameter->sendValueChangedMessageToListeners(value);
+                }
+                
+                if (processor.isUsingDoublePrecision()) {
+                    processor.processBlock(doubleBlock, midi);
+                } else {
+                    processor.processBlock(block, midi);
+                }
+            }
+            
+            playHead.samplePosition += numSamples;
+            numBlocks += 1;
+        }
+    }
+    
+    processor.releaseResources();
+    return numBlocks;
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    initialiseRealtimeChecks();
+    
+    juce::int64 seed = argc > 1 ? juce::String(argv[1]).getLargeIntValue() : 1;
+    int numRounds = argc > 2 ? juce::String(argv[2]).getIntValue() : 40;
+    
+    juce::Random random(seed);
+    
+    DelayDSPAudioProcessor processor;
+    HostPlayHead playHead;
+    processor.setPlayHead(&playHead);
+    
+    // The editor listens to parameters, and automation reaches those
+    // listeners on the audio thread. This is the message thread, so the
+    // blocks are played on a thread of their own.
+    std::unique_ptr<juce::AudioProcessorEditor> editor(processor.createEditorIfNeeded());
+    
+    juce::int64 numBlocks = 0;
+    std::thread audioThread([&] { numBlocks = playRounds(processor, playHead, random, numRounds); });
+    audioThread.join();
+    
+    editor.reset();
+    
+    std::cout << "No real-time safety violations in " << numBlocks << " blocks" << std::endl;
+    return 0;
+}
@@ -0,0 +1,352 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.cpp
+    Created: 17 Oct 2026 9:34:06pm
+    Author:  Johan Bremin
+
+    Linux only. The allocation functions forward to glibc's __libc_ versions,
+    everything else to the next definition found with dlsym(RTLD_NEXT).
+
+  ==============================================================================
+*/
+
+#include "RealtimeCheck.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void* ptr);
+}
+
+namespace
+{
+
+thread_local int checkDepth = 0;
+thread_local int allowLocksDepth = 0;
+
+// Goes straight to the kernel, so that it doesn't trip the write() check.
+void printError(const char* text) noexcept
+{
+    [[maybe_unused]] auto result = ::syscall(SYS_write, STDERR_FILENO, text, std::strlen(text));
+}
+
+[[noreturn]] void fail(const char* function) noexcept
+{
+    checkDepth = 0;
+    
+    printError("\n*** Real-time safety violation: ");
+    printError(function);
+    printError(" called on the audio thread\n");
+    
+    void* frames[64];
+    int numFrames = backtrace(frames, 64);
+    backtrace_symbols_fd(frames, numFrames, STDERR_FILENO);
+    
+    _exit(1);
+}
+
+inline void check(const char* function) noexcept
+{
+    if (checkDepth > 0) {
+        fail(function);
+    }
+}
+
+// dlsym() may allocate, which must not count as a violation.
+template<typename Function>
+Function findNext(const char* name) noexcept
+{
+    int depth = checkDepth;
+    checkDepth = 0;
+    auto function = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+    checkDepth = depth;
+    return function;
+}
+
+void* allocate(std::size_t size, const char* function)
+{
+    check(function);
+    if (void* ptr = __libc_malloc(size == 0 ? 1 : size)) { return ptr; }
+    throw std::bad_alloc();
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment, const char* function)
+{
+    check(function);
+    if (void* ptr = __libc_memalign(std::size_t(alignment), size == 0 ? 1 : size)) { return ptr; }
+    throw std::bad_alloc();
+}
+
+void deallocate(void* ptr, const char* function) noexcept
+{
+    if (ptr != nullptr) {
+        check(function);
+        __libc_free(ptr);
+    }
+}
+
+} // namespace
+
+ScopedRealtimeCheck::ScopedRealtimeCheck() noexcept
+{
+    checkDepth += 1;
+}
+
+ScopedRealtimeCheck::~ScopedRealtimeCheck() noexcept
+{
+    checkDepth -= 1;
+}
+
+ScopedAllowLocks::ScopedAllowLocks() noexcept
+{
+    allowLocksDepth += 1;
+}
+
+ScopedAllowLocks::~ScopedAllowLocks() noexcept
+{
+    allowLocksDepth -= 1;
+}
+
+void initialiseRealtimeChecks()
+{
+    void* frames[4];
+    backtrace(frames, 4);
+}
+
+//==============================================================================
+extern "C"
+{
+
+void* malloc(size_t size) noexcept
+{
+    check("malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept
+{
+    check("calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept
+{
+    check("realloc");
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) noexcept
+{
+    if (ptr != nullptr) {
+        check("free");
+    }
+    __libc_free(ptr);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) noexcept
+{
+    check("posix_memalign");
+    void* ptr = __libc_memalign(alignment, size);
+    if (ptr == nullptr) { return ENOMEM; }
+    *result = ptr;
+    return 0;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept
+{
+    check("aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept
+{
+    check("memalign");
+    return __libc_memalign(alignment, size);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+{
+    if (allowLocksDepth == 0) {
+        check("pthread_mutex_lock");
+    }
+    static const auto next = findNext<decltype(&pthread_mutex_lock)>("pthread_mutex_lock");
+    return next(mutex);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* lock) noexcept
+{
+    check("pthread_rwlock_rdlock");
+    static const auto next = findNext<decltype(&pthread_rwlock_rdlock)>("pthread_rwlock_rdlock");
+    return next(lock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* lock) noexcept
+{
+    check("pthread_rwlock_wrlock");
+    static const auto next = findNext<decltype(&pthread_rwlock_wrlock)>("pthread_rwlock_wrlock");
+    return next(lock);
+}
+
+int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex)
+{
+    check("pthread_cond_wait");
+    static const auto next = findNext<decltype(&pthread_cond_wait)>("pthread_cond_wait");
+    return next(condition, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex,
+                           const struct timespec* time)
+{
+    check("pthread_cond_timedwait");
+    static const auto next = findNext<decltype(&pthread_cond_timedwait)>("pthread_cond_timedwait");
+    return next(condition, mutex, time);
+}
+
+int pthread_cond_signal(pthread_cond_t* condition) noexcept
+{
+    check("pthread_cond_signal");
+    static const auto next = findNext<decltype(&pthread_cond_signal)>("pthread_cond_signal");
+    return next(condition);
+}
+
+int pthread_cond_broadcast(pthread_cond_t* condition) noexcept
+{
+    check("pthread_cond_broadcast");
+    static const auto next = findNext<decltype(&pthread_cond_broadcast)>("pthread_cond_broadcast");
+    return next(condition);
+}
+
+ssize_t write(int fd, const void* data, size_t size)
+{
+    check("write");
+    static const auto next = findNext<decltype(&write)>("write");
+    return next(fd, data, size);
+}
+
+ssize_t read(int fd, void* data, size_t size)
+{
+    check("read");
+    static const auto next = findNext<decltype(&read)>("read");
+    return next(fd, data, size);
+}
+
+int nanosleep(const struct timespec* duration, struct timespec* remaining)
+{
+    check("nanosleep");
+    static const auto next = findNext<decltype(&nanosleep)>("nanosleep");
+    return next(duration, remaining);
+}
+
+int clock_nanosleep(clockid_t clock, int flags, const struct timespec* time,
+                    struct timespec* remaining)
+{
+    check("clock_nanosleep");
+    static const auto next = findNext<decltype(&clock_nanosleep)>("clock_nanosleep");
+    return next(clock, flags, time, remaining);
+}
+
+int usleep(useconds_t microseconds)
+{
+    check("usleep");
+    static const auto next = findNext<decltype(&usleep)>("usleep");
+    return next(microseconds);
+}
+
+int sched_yield() noexcept
+{
+    check("sched_yield");
+    static const auto next = findNext<decltype(&sched_yield)>("sched_yield");
+    return next();
+}
+
+} // extern "C"
+
+//==============================================================================
+void* operator new(std::size_t size)
+{
+    return allocate(size, "operator new");
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate(size, "operator new[]");
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    check("operator new");
+    return __libc_malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    check("operator new[]");
+    return __libc_malloc(size == 0 ? 1 : size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocateAligned(size, alignment, "operator new");
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocateAligned(size, alignment, "operator new[]");
+}
+
+void operator delete(void* ptr) noexcept
+{
+    deallocate(ptr, "operator delete");
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    deallocate(ptr, "operator delete[]");
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    deallocate(ptr, "operator delete");
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    deallocate(ptr, "operator delete[]");
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    deallocate(ptr, "operator delete");
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    deallocate(ptr, "operator delete[]");
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    deallocate(ptr, "operator delete");
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    deallocate(ptr, "operator delete[]");
+}
@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.h
+    Created: 17 Oct 2026 9:34:06pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/*
+  While a ScopedRealtimeCheck exists, any heap allocation, mutex lock or
+  blocking system call on the same thread is a violation: it prints what
+  happened plus a stack trace and ends the program with a failure code.
+
+  This works by replacing malloc, operator new and friends in the test
+  executable, so it must never be linked into the plug-in itself.
+*/
+struct ScopedRealtimeCheck
+{
+    ScopedRealtimeCheck() noexcept;
+    ~ScopedRealtimeCheck() noexcept;
+    
+    ScopedRealtimeCheck(const ScopedRealtimeCheck&) = delete;
+    ScopedRealtimeCheck& operator=(const ScopedRealtimeCheck&) = delete;
+};
+
+// Inside a ScopedRealtimeCheck, lets this thread lock mutexes while it
+// exists. Plug-in wrappers tell the parameter listeners about automation
+// on the audio thread, and JUCE guards each listener list with a mutex the
+// plug-in has no say over. Allocations and blocking calls stay violations.
+struct ScopedAllowLocks
+{
+    ScopedAllowLocks() noexcept;
+    ~ScopedAllowLocks() noexcept;
+    
+    ScopedAllowLocks(const ScopedAllowLocks&) = delete;
+    ScopedAllowLocks& operator=(const ScopedAllowLocks&) = delete;
+};
+
+// Call once at startup, before the first check. The stack trace code
+// allocates the first time it runs, so this gets that out of the way.
+void initialiseRealtimeChecks();
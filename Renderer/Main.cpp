@@ -0,0 +1,338 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 6:12:35pm
+    Author:  Johan Bremin
+
+    Offline renderer. Runs audio files through DelayDSPAudioProcessor without
+    a host, using large blocks and one processor per worker thread.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+
+// Reports a fixed tempo to the processor and counts the samples rendered so
+// far, like the transport of a host that is playing from the start.
+class RenderPlayHead : public juce::AudioPlayHead
+{
+public:
+    explicit RenderPlayHead(double bpmToUse) : bpm(bpmToUse)
+    {
+    }
+    
+    void reset(double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+        samplePosition = 0;
+    }
+    
+    void advance(int numSamples) noexcept
+    {
+        samplePosition += numSamples;
+    }
+    
+    juce::Optional<PositionInfo> getPosition() const override
+    {
+        PositionInfo info;
+        info.setBpm(bpm);
+        info.setTimeInSamples(samplePosition);
+        info.setTimeInSeconds(double(samplePosition) / sampleRate);
+        info.setIsPlaying(true);
+        return info;
+    }
+    
+private:
+    double bpm;
+    double sampleRate = 44100.0;
+    juce::int64 samplePosition = 0;
+};
+
+struct RenderSettings
+{
+    juce::File outputFolder;
+    juce::MemoryBlock preset;
+    double bpm = 120.0;
+    double tailSeconds = 0.0;
+    int blockSize = 8192;
+};
+
+// Shared between all the workers. Each worker takes the next file that has
+// not been rendered yet until the list runs out.
+class RenderQueue
+{
+public:
+    explicit RenderQueue(juce::Array<juce::File> filesToRender) : files(std::move(filesToRender))
+    {
+    }
+    
+    bool getNextFile(juce::File& file)
+    {
+        int index = nextIndex++;
+        if (index >= files.size()) { return false; }
+        file = files[index];
+        return true;
+    }
+    
+    void report(const juce::String& message, bool failed)
+    {
+        const juce::ScopedLock lock(outputLock);
+        if (failed) {
+            std::cerr << message << std::endl;
+            numFailed += 1;
+        } else {
+            std::cout << message << std::endl;
+        }
+    }
+    
+    int getNumFailed() const noexcept
+    {
+        return numFailed;
+    }
+    
+private:
+    juce::Array<juce::File> files;
+    std::atomic<int> nextIndex = 0;
+    
+    juce::CriticalSection outputLock;
+    int numFailed = 0;
+};
+
+class RenderJob : public juce::ThreadPoolJob
+{
+public:
+    RenderJob(RenderQueue& queueToUse, const RenderSettings& settingsToUse,
+              juce::AudioFormatManager& formatManagerToUse) :
+        juce::ThreadPoolJob("Render"),
+        queue(queueToUse),
+        settings(settingsToUse),
+        formatManager(formatManagerToUse),
+        playHead(settings.bpm)
+    {
+        processor.setPlayHead(&playHead);
+        processor.setNonRealtime(true);
+        
+        if (!settings.preset.isEmpty()) {
+            processor.setStateInformation(settings.preset.getData(), int(settings.preset.getSize()));
+        }
+    }
+    
+    JobStatus runJob() override
+    {
+        juce::File file;
+        while (!shouldExit() && queue.getNextFile(file)) {
+            juce::String error = render(file);
+            if (error.isEmpty()) {
+                queue.report("Rendered " + file.getFileName(), false);
+            } else {
+                queue.report(file.getFileName() + ": " + error, true);
+            }
+        }
+        return jobHasFinished;
+    }
+    
+private:
+    juce::String render(const juce::File& inputFile)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(inputFile));
+        if (reader == nullptr) {
+            return "unsupported or unreadable audio file";
+        }
+        
+        auto* format = formatManager.findFormatForFileExtension(inputFile.getFileExtension());
+        if (format == nullptr) {
+            return "no writer for this file type";
+        }
+        
+        int bitsPerSample = int(reader->bitsPerSample);
+        if (!format->getPossibleBitDepths().contains(bitsPerSample)) {
+            bitsPerSample = 24;
+        }
+        
+        auto outputFile = settings.outputFolder.getChildFile(inputFile.getFileName());
+        outputFile.deleteFile();
+        
+        std::unique_ptr<juce::OutputStream> stream = outputFile.createOutputStream();
+        if (stream == nullptr) {
+            return "cannot create " + outputFile.getFullPathName();
+        }
+        
+        // Mono and stereo files are rendered in stereo, larger files with a
+        // delay line per channel.
+        int numChannels = std::max(int(reader->numChannels), 2);
+        if (numChannels > DelayLine<float>::maxChannels) {
+            return "too many channels";
+        }
+        
+        std::unique_ptr<juce::AudioFormatWriter> writer(
+            format->createWriterFor(stream.get(), reader->sampleRate, juce::uint32(numChannels),
+                                    bitsPerSample, reader->metadataValues, 0));
+        if (writer == nullptr) {
+            return "cannot write " + outputFile.getFullPathName();
+        }
+        stream.release();  // now owned by the writer
+        
+        double sampleRate = reader->sampleRate;
+        int blockSize = settings.blockSize;
+        
+        auto channelSet = numChannels == 2 ? juce::AudioChannelSet::stereo()
+                                           : juce::AudioChannelSet::canonicalChannelSet(numChannels);
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(channelSet);
+        layout.outputBuses.add(channelSet);
+        if (!processor.setBusesLayout(layout)) {
+            return "unsupported channel layout";
+        }
+        
+        // Preparing the processor again also clears the delay line left over
+        // from the previous file.
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+        playHead.reset(sampleRate);
+        
+        // The buffer must have exactly as many channels as the processor,
+        // so that a mono file gets copied to both stereo channels.
+        buffer.setSize(numChannels, blockSize, false, false, true);
+        
+        auto numSamples = reader->lengthInSamples
+                        + juce::int64(settings.tailSeconds * sampleRate);
+        
+        for (juce::int64 position = 0; position < numSamples; position += blockSize) {
+            int count = int(std::min(juce::int64(blockSize), numSamples - position));
+            
+            // Mono files are copied to both channels. Reading past the end
+            // of the file gives silence, which renders the tail.
+            reader->read(&buffer, 0, count, position, true, true);
+            
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, count);
+            processor.processBlock(block, midi);
+            playHead.advance(count);
+            
+            if (!writer->writeFromAudioSampleBuffer(block, 0, count)) {
+                return "write error";
+            }
+        }
+        
+        processor.releaseResources();
+        return {};
+    }
+    
+    RenderQueue& queue;
+    const RenderSettings& settings;
+    juce::AudioFormatManager& formatManager;
+    
+    RenderPlayHead playHead;
+    DelayDSPAudioProcessor processor;
+    
+    juce::AudioBuffer<float> buffer;
+    juce::MidiBuffer midi;
+};
+
+static void printUsage()
+{
+    std::cout << "Usage: DelayDSPRenderer --output <folder> [options] <files...>\n"
+                 "\n"
+                 "  --output <folder>    where to write the rendered files\n"
+                 "  --preset <file>      plug-in state saved by the host (XML)\n"
+                 "  --bpm <tempo>        tempo for synced delay times (default 120)\n"
+                 "  --tail <seconds>     silence to render after each file (default 0)\n"
+                 "  --block-size <n>     samples per processBlock call (default 8192)\n"
+                 "  --threads <n>        number of worker threads (default: all cores)\n";
+}
+
+// The preset is normally the XML from getStateInformation, but the binary
+// state blob that the plug-in saves is accepted as well.
+static bool loadPreset(const juce::File& file, juce::MemoryBlock& preset)
+{
+    if (!file.existsAsFile()) { return false; }
+    
+    if (auto xml = juce::parseXML(file)) {
+        juce::AudioProcessor::copyXmlToBinary(*xml, preset);
+        return true;
+    }
+    return file.loadFileAsData(preset);
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // APVTS needs the message manager, even though its loop never runs here.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    RenderSettings settings;
+    juce::Array<juce::File> files;
+    int numThreads = juce::SystemStats::getNumCpuCores();
+    
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i) {
+        args.add(juce::CharPointer_UTF8(argv[i]));
+    }
+    
+    for (int i = 0; i < args.size(); ++i) {
+        const auto& arg = args[i];
+        
+        if (arg.startsWith("--")) {
+            if (i + 1 >= args.size()) {
+                printUsage();
+                return 1;
+            }
+            
+            auto value = args[++i];
+            auto cwd = juce::File::getCurrentWorkingDirectory();
+            
+            if (arg == "--output") {
+                settings.outputFolder = cwd.getChildFile(value);
+            } else if (arg == "--preset") {
+                if (!loadPreset(cwd.getChildFile(value), settings.preset)) {
+                    std::cerr << "Cannot load preset " << value << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--bpm") {
+                settings.bpm = juce::jlimit(20.0, 999.0, value.getDoubleValue());
+            } else if (arg == "--tail") {
+                settings.tailSeconds = std::max(0.0, value.getDoubleValue());
+            } else if (arg == "--block-size") {
+                settings.blockSize = juce::jlimit(32, 65536, value.getIntValue());
+            } else if (arg == "--threads") {
+                numThreads = juce::jmax(1, value.getIntValue());
+            } else {
+                printUsage();
+                return 1;
+            }
+        } else {
+            files.add(juce::File::getCurrentWorkingDirectory().getChildFile(arg));
+        }
+    }
+    
+    if (files.isEmpty() || settings.outputFolder == juce::File()) {
+        printUsage();
+        return 1;
+    }
+    
+    if (!settings.outputFolder.createDirectory()) {
+        std::cerr << "Cannot create " << settings.outputFolder.getFullPathName() << std::endl;
+        return 1;
+    }
+    
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    
+    numThreads = std::min(numThreads, files.size());
+    RenderQueue queue(files);
+    
+    // Every worker gets its own job and so its own processor, which it keeps
+    // for all the files it renders.
+    {
+        juce::ThreadPool pool(numThreads);
+        for (int i = 0; i < numThreads; ++i) {
+            pool.addJob(new RenderJob(queue, settings, formatManager), true);
+        }
+        while (pool.getNumJobs() > 0) {
+            juce::Thread::sleep(50);
+        }
+    }
+    
+    return queue.getNumFailed() > 0 ? 1 : 0;
+}
@@ -11,79 +11,99 @@
 #include <JuceHeader.h>
 #include "DelayLine.h"
 
-void DelayLine::setMaximumDelayInSamples(int maxLengthInSamples)
+template<typename SampleType>
+int DelayLine<SampleType>::getPaddedLength(int maxLengthInSamples) noexcept
+{
+    // Round up to a power of two so the indices can wrap around with a mask.
+    return juce::nextPowerOfTwo(maxLengthInSamples + maxInterpolationTaps);
+}
+
+template<typename SampleType>
+size_t DelayLine<SampleType>::getMemorySize(int maxLengthInSamples, int numChannels,
+                                            DelayLineStorage storage) noexcept
+{
+    size_t size = size_t((getPaddedLength(maxLengthInSamples) + guardLength) * numChannels);
+    size_t sampleSize = storage == DelayLineStorage::half ? sizeof(uint16_t) : sizeof(SampleType);
+    return size * sampleSize + MemoryArena::cacheLineSize;
+}
+
+template<typename SampleType>
+void DelayLine<SampleType>::setMaximumDelayInSamples(MemoryArena& memory, int maxLengthInSamples,
+                                                     int numChannels_, DelayLineStorage newStorage)
 {
     jassert(maxLengthInSamples > 0);
+    jassert(numChannels_ > 0 && numChannels_ <= maxChannels);
     
-    int paddedLength = maxLengthInSamples + 2;
+    bufferLength = getPaddedLength(maxLengthInSamples);
+    numChannels = numChannels_;
+    storage = newStorage;
+    wrapMask = bufferLength - 1;
     
-    if (bufferLength < paddedLength) {
-        bufferLength = paddedLength;
-        
-        buffer.reset(new float[size_t(bufferLength)]);
+    size_t size = size_t((bufferLength + guardLength) * numChannels);
+    if (storage == DelayLineStorage::half) {
+        buffer = nullptr;
+        halfBuffer = memory.allocate<uint16_t>(size);
+    } else {
+        buffer = memory.allocate<SampleType>(size);
+        halfBuffer = nullptr;
     }
 }
 
-void DelayLine::reset() noexcept
+template<typename SampleType>
+void DelayLine<SampleType>::reset() noexcept
 {
     writeIndex = bufferLength - 1;
+    freshFrames = bufferLength;
     
-    for (size_t i = 0; i < size_t(bufferLength); ++i) {
-        buffer[i] = 0.0f;
+    size_t size = size_t((bufferLength + guardLength) * numChannels);
+    if (storage == DelayLineStorage::half) {
+        std::fill(halfBuffer, halfBuffer + size, uint16_t(0));
+    } else {
+        std::fill(buffer, buffer + size, SampleType(0));
     }
 }
 
-void DelayLine::write(float input) noexcept
+template<typename SampleType>
+void DelayLine<SampleType>::write(const SampleType* frame) noexcept
 {
     jassert(bufferLength > 0);
     
-    writeIndex += 1;
-    
-    if (writeIndex >= bufferLength) {
-        writeIndex = 0;
+    if (storage == DelayLineStorage::half) {
+        uint16_t encoded[maxChannels];
+        encodeHalf(frame, encoded, numChannels);
+        writeFrame(halfBuffer, encoded);
+    } else {
+        writeFrame(buffer, frame);
     }
     
-    buffer[size_t(writeIndex)] = input;
+    freshFrames = std::min(freshFrames + 1, bufferLength);
 }
 
-float DelayLine::read(float delayInSamples) const noexcept
+template<typename SampleType>
+void DelayLine<SampleType>::writeBlock(const SampleType* input, int numSamples) noexcept
 {
-    jassert(delayInSamples >= 1.0f);
-    jassert(delayInSamples <= bufferLength - 2.0f);
-    
-    int integerDelay = int(delayInSamples);
-    
-    int readIndexA = writeIndex - integerDelay + 1; int readIndexB = readIndexA - 1;
-    int readIndexC = readIndexA - 2;
-    int readIndexD = readIndexA - 3;
+    jassert(bufferLength > 0);
     
-    if (readIndexD < 0) {
-        readIndexD += bufferLength;
-        if (readIndexC < 0) {
-            readIndexC += bufferLength;
-            if (readIndexB < 0) {
-                readIndexB += bufferLength;
-                if (readIndexA < 0) {
-                    readIndexA += bufferLength;
-                }
+    if (storage == DelayLineStorage::half) {
+        // Encode up to maxBlockSize frames at a time, then write them.
+        uint16_t encoded[maxBlockSize * maxChannels];
+        
+        for (int offset = 0; offset < numSamples; offset += maxBlockSize) {
+            int count = std::min(numSamples - offset, maxBlockSize);
+            encodeHalf(input + offset * numChannels, encoded, count * numChannels);
+            
+            for (int i = 0; i < count; ++i) {
+                writeFrame(halfBuffer, encoded + i * numChannels);
             }
         }
+    } else {
+        for (int i = 0; i < numSamples; ++i) {
+            writeFrame(buffer, input + i * numChannels);
+        }
     }
     
-    float sampleA = buffer[size_t(readIndexA)];
-    float sampleB = buffer[size_t(readIndexB)];
-    float sampleC = buffer[size_t(readIndexC)];
-    float sampleD = buffer[size_t(readIndexD)];
-    
-    float fraction = delayInSamples - float(integerDelay);
-    float slope0 = (sampleC - sampleA) * 0.5f;
-    float slope1 = (sampleD - sampleB) * 0.5f;
-    float v = sampleB - sampleC;
-    float w = slope0 + v;
-    float a = w + v + slope1;
-    float b = w + a;
-    float stage1 = a * fraction - b;
-    float stage2 = stage1 * fraction + slope0;
-    
-    return stage2 * fraction + sampleB;
+    freshFrames = std::min(freshFrames + numSamples, bufferLength);
 }
+
+template class DelayLine<float>;
+template class DelayLine<double>;
@@ -10,23 +10,345 @@
 
 #pragma once
 
-#include <memory>
+#include "Interpolators.h"
+#include "Kernels.h"
+#include "MemoryArena.h"
 
+// How DelayLine stores its samples. Half floats take half the memory and
+// memory bandwidth of float, at about 66 dB of signal to noise ratio for
+// every pass through the delay line. They are converted with the kernels
+// in Kernels.h on write and read; the interpolation runs at full precision.
+enum class DelayLineStorage
+{
+    full,
+    half,
+};
+
+// Delay line for one or more channels. The channels are stored interleaved,
+// so all channels of the same frame share a cache line.
+//
+// The read functions are templated on the interpolator, see Interpolators.h.
+// Choosing the interpolator happens at compile time, so there is no dispatch
+// inside the read loops.
+//
+// SampleType is float or double, for the two precisions the host can ask for.
+// The delay times are float in both cases.
+//
+// For long delays in many instances the samples can be stored as half
+// floats instead, see DelayLineStorage.
+//
+// The buffer comes from a MemoryArena that the owner reserves, so all of it
+// is paged in (and optionally locked) before the audio thread uses it, not
+// when a longer delay first reaches into it.
+template<typename SampleType>
 class DelayLine
 {
 public:
-    void setMaximumDelayInSamples(int maxLengthInSamples);
+    // Takes the buffer from the arena, which needs getMemorySize() bytes of
+    // room for it. The arena owns the memory: reserving it again takes the
+    // buffer away, until this is called again.
+    void setMaximumDelayInSamples(MemoryArena& memory, int maxLengthInSamples, int numChannels = 1,
+                                  DelayLineStorage newStorage = DelayLineStorage::full);
+    
+    static size_t getMemorySize(int maxLengthInSamples, int numChannels,
+                                DelayLineStorage storage) noexcept;
+    
     void reset() noexcept;
     
-    void write(float input) noexcept;
-    float read(float delayInSamples) const noexcept;
+    // Makes the delay line read as silence, like reset(), but without
+    // touching the buffer, so it is cheap enough for the audio thread. The
+    // old frames are read as zero until new writes have replaced them.
+    void clear() noexcept
+    {
+        freshFrames = 0;
+    }
+    
+    // Writes one frame, i.e. one sample for every channel.
+    void write(const SampleType* frame) noexcept;
+    
+    template<typename Interpolator>
+    SampleType read(int channel, float delayInSamples, Interpolator& interpolator) const noexcept;
+    
+    SampleType read(int channel, float delayInSamples) const noexcept
+    {
+        HermiteInterpolation<SampleType> interpolator;
+        return read(channel, delayInSamples, interpolator);
+    }
+    
+    // Block versions of write() and read(). The input and output hold
+    // interleaved frames. readBlock() looks ahead into the next writeBlock():
+    // output frame i is what read() would return right after frame i of that
+    // block was written. This lets a feedback loop read a whole block first
+    // and write it afterwards, as long as every delay is longer than the block.
+    void writeBlock(const SampleType* input, int numSamples) noexcept;
+    
+    template<typename Interpolator>
+    void readBlock(const float* delayInSamples, SampleType* output, int numSamples,
+                   Interpolator& interpolator) const noexcept;
+    
+    void readBlock(const float* delayInSamples, SampleType* output, int numSamples) const noexcept
+    {
+        HermiteInterpolation<SampleType> interpolator;
+        readBlock(delayInSamples, output, numSamples, interpolator);
+    }
+    
+    // Reads several taps for every frame of the next block, in a single pass.
+    // Tap t of frame i has the delay tapDelayInSamples[i * numTaps + t] and
+    // goes to output frame i * numTaps + t. Like readBlock(), every tap must
+    // be longer than the block.
+    template<typename Interpolator>
+    void readTapsBlock(const float* tapDelayInSamples, int numTaps, SampleType* output,
+                       int numSamples, Interpolator& interpolator) const noexcept;
+    
+    static constexpr int maxBlockSize = 32;
+    static constexpr int maxChannels = 16;
+    static constexpr int maxInterpolationTaps = 8;
+    static constexpr int maxNewerTaps = maxInterpolationTaps / 2;
+    
+    // The shortest delay that readBlock() and readTapsBlock() accept for a
+    // full block, whatever the interpolator.
+    static constexpr int minBlockDelay = maxBlockSize + maxNewerTaps;
     
     int getBufferLength() const noexcept
     {
         return bufferLength;
     }
+    
+    int getNumChannels() const noexcept
+    {
+        return numChannels;
+    }
+    
+    DelayLineStorage getStorage() const noexcept
+    {
+        return storage;
+    }
 private:
-    std::unique_ptr<float[]> buffer;
+    // Shared implementation of readBlock() and readTapsBlock(). There are
+    // readsPerFrame reads for every frame of the next block, and read r uses
+    // delayInSamples[r % numDelays].
+    template<typename Interpolator>
+    void readInterleaved(const float* delayInSamples, int numDelays, int readsPerFrame,
+                         int numReads, SampleType* output, Interpolator& interpolator) const noexcept;
+    
+    static int getPaddedLength(int maxLengthInSamples) noexcept;
+    
+    // Whether the frame at index was written after the last clear().
+    bool isFresh(int index) const noexcept
+    {
+        return ((writeIndex - index) & wrapMask) < freshFrames;
+    }
+    
+    template<typename StorageType>
+    void writeFrame(StorageType* data, const StorageType* frame) noexcept;
+    
+    // Converts numValues samples from and to half floats.
+    static void encodeHalf(const SampleType* input, uint16_t* output, int numValues) noexcept;
+    static void decodeHalf(const uint16_t* input, SampleType* output, int numValues) noexcept;
+    
+    // Number of frames past the end of the buffer that mirror its start.
+    static constexpr int guardLength = maxInterpolationTaps - 1;
+    
+    // Only one of these points into the arena, depending on the storage.
+    SampleType* buffer = nullptr;
+    uint16_t* halfBuffer = nullptr;
+    DelayLineStorage storage = DelayLineStorage::full;
+    
     int bufferLength = 0;
+    int numChannels = 0;
+    int wrapMask = 0;
     int writeIndex = 0;
+    
+    // Number of frames written since clear(), up to the buffer length.
+    int freshFrames = 0;
 };
+
+static_assert(ThiranInterpolation<float>::maxChannels >= DelayLine<float>::maxChannels);
+
+template<typename SampleType>
+template<typename Interpolator>
+SampleType DelayLine<SampleType>::read(int channel, float delayInSamples, Interpolator& interpolator) const noexcept
+{
+    constexpr int numTaps = Interpolator::numTaps;
+    constexpr int newerTaps = Interpolator::newerTaps;
+    static_assert(numTaps <= maxInterpolationTaps && newerTaps <= maxNewerTaps);
+    
+    jassert(channel >= 0 && channel < numChannels);
+    jassert(delayInSamples >= float(newerTaps));
+    jassert(delayInSamples < float(bufferLength - numTaps + newerTaps + 1));
+    
+    int integerDelay = int(delayInSamples);
+    
+    // Thanks to the guard region, the frames holding the taps are always next
+    // to each other in memory, starting from the oldest one.
+    int readIndex = (writeIndex + newerTaps - integerDelay - (numTaps - 1)) & wrapMask;
+    float fraction = delayInSamples - float(integerDelay);
+    
+    // The oldest tap is the first to be left over from before a clear().
+    if (storage == DelayLineStorage::half || !isFresh(readIndex)) {
+        SampleType taps[numTaps];
+        for (int k = 0; k < numTaps; ++k) {
+            int index = (readIndex + k) * numChannels + channel;
+            SampleType sample = storage == DelayLineStorage::half ? SampleType(halfToFloat(halfBuffer[index]))
+                                                                  : buffer[index];
+            taps[k] = isFresh(readIndex + k) ? sample : SampleType(0);
+        }
+        return interpolator.interpolate(taps, 1, fraction, channel);
+    }
+    
+    const SampleType* taps = buffer + readIndex * numChannels + channel;
+    return interpolator.interpolate(taps, numChannels, fraction, channel);
+}
+
+template<typename SampleType>
+template<typename Interpolator>
+void DelayLine<SampleType>::readBlock(const float* delayInSamples, SampleType* output, int numSamples,
+                                      Interpolator& interpolator) const noexcept
+{
+    jassert(numSamples <= maxBlockSize);
+    
+    readInterleaved(delayInSamples, numSamples, 1, numSamples, output, interpolator);
+}
+
+template<typename SampleType>
+template<typename Interpolator>
+void DelayLine<SampleType>::readTapsBlock(const float* tapDelayInSamples, int numTaps, SampleType* output,
+                                          int numSamples, Interpolator& interpolator) const noexcept
+{
+    jassert(numSamples <= maxBlockSize);
+    
+    readInterleaved(tapDelayInSamples, numSamples * numTaps, numTaps, numSamples * numTaps, output, interpolator);
+}
+
+template<typename SampleType>
+template<typename Interpolator>
+void DelayLine<SampleType>::readInterleaved(const float* delayInSamples, int numDelays, int readsPerFrame,
+                                            int numReads, SampleType* output,
+                                            Interpolator& interpolator) const noexcept
+{
+    constexpr int numTaps = Interpolator::numTaps;
+    constexpr int newerTaps = Interpolator::newerTaps;
+    constexpr int maxValues = maxBlockSize * maxChannels;
+    constexpr size_t alignment = juce::dsp::SIMDRegister<SampleType>::SIMDRegisterSize;
+    constexpr int numLanes = int(juce::dsp::SIMDRegister<SampleType>::SIMDNumElements);
+    static_assert(numTaps <= maxInterpolationTaps && newerTaps <= maxNewerTaps);
+    static_assert(maxValues % numLanes == 0);
+    
+    // Tap k of value j is stored at taps[k * maxValues + j]. The values are
+    // interleaved frames just like the output, so each SIMD lane in the
+    // interpolator is one channel of one read.
+    alignas(alignment) SampleType taps[numTaps * maxValues];
+    alignas(alignment) float fraction[maxValues];
+    alignas(alignment) SampleType result[maxValues];
+    
+    // the frames of a single read, when they have to be decoded first
+    SampleType decoded[maxInterpolationTaps * maxChannels];
+    
+    int numSamples = numReads / readsPerFrame;
+    int maxReadsPerPass = maxValues / numChannels;
+    
+    for (int firstRead = 0; firstRead < numReads; firstRead += maxReadsPerPass) {
+        int numPassReads = std::min(numReads - firstRead, maxReadsPerPass);
+        
+        // Gather the taps for every read. Because the delay is longer than the
+        // block, none of these taps belong to the block that is yet to be written.
+        for (int r = 0; r < numPassReads; ++r) {
+            int read = firstRead + r;
+            int frame = read / readsPerFrame;
+            float delay = delayInSamples[read % numDelays];
+            
+            jassert(delay >= float(numSamples + newerTaps));
+            jassert(delay < float(bufferLength - numTaps + newerTaps + 1));
+            
+            int integerDelay = int(delay);
+            float delayFraction = delay - float(integerDelay);
+            
+            int readIndex = (writeIndex + frame + 1 + newerTaps - integerDelay - (numTaps - 1)) & wrapMask;
+            // The frames of the taps are next to each other, so compact
+            // storage can decode them in one go.
+            const SampleType* frames = decoded;
+            if (storage == DelayLineStorage::half) {
+                decodeHalf(halfBuffer + readIndex * numChannels, decoded, numTaps * numChannels);
+            } else {
+                frames = buffer + readIndex * numChannels;
+            }
+            
+            for (int channel = 0; channel < numChannels; ++channel) {
+                int j = r * numChannels + channel;
+                for (int k = 0; k < numTaps; ++k) {
+                    taps[k * maxValues + j] = frames[k * numChannels + channel];
+                }
+                fraction[j] = delayFraction;
+            }
+            
+            // Silence the taps that are left over from before a clear().
+            if (!isFresh(readIndex)) {
+                for (int k = 0; k < numTaps && !isFresh(readIndex + k); ++k) {
+                    for (int channel = 0; channel < numChannels; ++channel) {
+                        taps[k * maxValues + r * numChannels + channel] = 0;
+                    }
+                }
+            }
+        }
+        
+        // Pad the last SIMD register so the kernels never touch uninitialized memory.
+        int numValues = numPassReads * numChannels;
+        int numVectorValues = (numValues + numLanes - 1) / numLanes * numLanes;
+        for (int j = numValues; j < numVectorValues; ++j) {
+            for (int k = 0; k < numTaps; ++k) {
+                taps[k * maxValues + j] = 0;
+            }
+            fraction[j] = 0.0f;
+        }
+        
+        interpolator.interpolateBlock(taps, maxValues, fraction, result, numValues, numChannels);
+        
+        SampleType* destination = output + firstRead * numChannels;
+        for (int j = 0; j < numValues; ++j) {
+            destination[j] = result[j];
+        }
+    }
+}
+
+template<typename SampleType>
+template<typename StorageType>
+void DelayLine<SampleType>::writeFrame(StorageType* data, const StorageType* frame) noexcept
+{
+    writeIndex = (writeIndex + 1) & wrapMask;
+    
+    // The guard region past the end of the buffer mirrors the first frames.
+    // Outside of that range, the frame simply gets written twice.
+    int mirrorIndex = writeIndex < guardLength ? writeIndex + bufferLength : writeIndex;
+    
+    StorageType* destination = data + writeIndex * numChannels;
+    StorageType* mirror = data + mirrorIndex * numChannels;
+    
+    for (int channel = 0; channel < numChannels; ++channel) {
+        destination[channel] = frame[channel];
+        mirror[channel] = frame[channel];
+    }
+}
+
+template<typename SampleType>
+void DelayLine<SampleType>::encodeHalf(const SampleType* input, uint16_t* output, int numValues) noexcept
+{
+    if constexpr (std::is_same_v<SampleType, float>) {
+        getKernels().encodeHalf(input, output, numValues);
+    } else {
+        for (int i = 0; i < numValues; ++i) {
+            output[i] = floatToHalf(float(input[i]));
+        }
+    }
+}
+
+template<typename SampleType>
+void DelayLine<SampleType>::decodeHalf(const uint16_t* input, SampleType* output, int numValues) noexcept
+{
+    if constexpr (std::is_same_v<SampleType, float>) {
+        getKernels().decodeHalf(input, output, numValues);
+    } else {
+        for (int i = 0; i < numValues; ++i) {
+            output[i] = SampleType(halfToFloat(input[i]));
+        }
+    }
+}
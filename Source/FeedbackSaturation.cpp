@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    FeedbackSaturation.cpp
+    Created: 17 Oct 2026 11:14:37pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#include "FeedbackSaturation.h"
+
+template<typename SampleType>
+void FeedbackSaturation<SampleType>::prepare([[maybe_unused]] double sampleRate, int numChannels)
+{
+    using Oversampling = juce::dsp::Oversampling<SampleType>;
+    constexpr auto filterType = Oversampling::filterHalfBandPolyphaseIIR;
+    
+    // The factor is given as the number of 2x stages. Integer latency adds
+    // a little fractional delay, so the latency can be compensated exactly.
+    oversampling2x = std::make_unique<Oversampling>(size_t(numChannels), 1, filterType, false, true);
+    oversampling4x = std::make_unique<Oversampling>(size_t(numChannels), 2, filterType, false, true);
+    oversampling2x->initProcessing(maxBlockSize);
+    oversampling4x->initProcessing(maxBlockSize);
+    
+    jassert(getLatencyInSamples(SaturationMode::oversample2x) <= maxLatency);
+    jassert(getLatencyInSamples(SaturationMode::oversample4x) <= maxLatency);
+    
+    channelBuffer.setSize(numChannels, maxBlockSize);
+    
+    reset();
+}
+
+template<typename SampleType>
+void FeedbackSaturation<SampleType>::reset() noexcept
+{
+    if (oversampling2x != nullptr) {
+        oversampling2x->reset();
+        oversampling4x->reset();
+    }
+}
+
+template<typename SampleType>
+juce::dsp::Oversampling<SampleType>* FeedbackSaturation<SampleType>::getOversampling(SaturationMode mode) const noexcept
+{
+    switch (mode) {
+        case SaturationMode::oversample2x: return oversampling2x.get();
+        case SaturationMode::oversample4x: return oversampling4x.get();
+        case SaturationMode::off: break;
+    }
+    return nullptr;
+}
+
+template<typename SampleType>
+int FeedbackSaturation<SampleType>::getLatencyInSamples(SaturationMode mode) const noexcept
+{
+    auto* oversampling = getOversampling(mode);
+    if (oversampling == nullptr) {
+        return 0;
+    }
+    return juce::roundToInt(oversampling->getLatencyInSamples());
+}
+
+template<typename SampleType>
+void FeedbackSaturation<SampleType>::process(SampleType* frames, int numSamples, const float* drive,
+                                             SaturationMode mode) noexcept
+{
+    auto* oversampling = getOversampling(mode);
+    if (oversampling == nullptr || numSamples == 0) {
+        return;
+    }
+    jassert(numSamples <= maxBlockSize);
+    
+    int numChannels = channelBuffer.getNumChannels();
+    for (int channel = 0; channel < numChannels; ++channel) {
+        SampleType* data = channelBuffer.getWritePointer(channel);
+        for (int i = 0; i < numSamples; ++i) {
+            data[i] = frames[i * numChannels + channel];
+        }
+    }
+    
+    juce::dsp::AudioBlock<SampleType> block(channelBuffer.getArrayOfWritePointers(),
+                                            size_t(numChannels), size_t(numSamples));
+    auto oversampledBlock = oversampling->processSamplesUp(block);
+    
+    // tanh(drive * x) / drive has unity gain for small signals and never
+    // more than that for large ones, so the feedback loop stays stable at
+    // any drive. The rational approximation is accurate up to |x| = 5.
+    int factor = int(oversampling->getOversamplingFactor());
+    int numOversampled = int(oversampledBlock.getNumSamples());
+    
+    for (size_t channel = 0; channel < oversampledBlock.getNumChannels(); ++channel) {
+        SampleType* data = oversampledBlock.getChannelPointer(channel);
+        for (int i = 0; i < numOversampled; ++i) {
+            SampleType gain = SampleType(drive[i / factor]);
+            SampleType x = std::clamp(data[i] * gain, SampleType(-5), SampleType(5));
+            SampleType y = std::clamp(juce::dsp::FastMathApproximations::tanh(x),
+                                      SampleType(-1), SampleType(1));
+            data[i] = y / gain;
+        }
+    }
+    
+    oversampling->processSamplesDown(block);
+    
+    for (int channel = 0; channel < numChannels; ++channel) {
+        const SampleType* data = channelBuffer.getReadPointer(channel);
+        for (int i = 0; i < numSamples; ++i) {
+            frames[i * numChannels + channel] = data[i];
+        }
+    }
+}
+
+template class FeedbackSaturation<float>;
+template class FeedbackSaturation<double>;
@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    FeedbackSaturation.h
+    Created: 17 Oct 2026 11:14:37pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Parameters.h"
+
+// Soft saturation for the feedback path. It runs at 2x or 4x the sample rate
+// to keep the harmonics it adds from aliasing, using JUCE's polyphase IIR
+// half-band filters. Only the feedback signal goes through here, the delay
+// line itself stays at the host rate.
+//
+// The oversampling filters delay the signal by a whole number of samples,
+// see getLatencyInSamples().
+template<typename SampleType>
+class FeedbackSaturation
+{
+public:
+    void prepare(double sampleRate, int numChannels);
+    void reset() noexcept;
+    
+    int getLatencyInSamples(SaturationMode mode) const noexcept;
+    
+    // Saturates numSamples interleaved frames in place. The drive is a
+    // linear gain for every sample.
+    void process(SampleType* frames, int numSamples, const float* drive, SaturationMode mode) noexcept;
+    
+    static constexpr int maxBlockSize = Parameters::maxBlockSize;
+    static constexpr int maxLatency = 16;
+    
+private:
+    juce::dsp::Oversampling<SampleType>* getOversampling(SaturationMode mode) const noexcept;
+    
+    std::unique_ptr<juce::dsp::Oversampling<SampleType>> oversampling2x;
+    std::unique_ptr<juce::dsp::Oversampling<SampleType>> oversampling4x;
+    
+    // the frames split into channels, as the oversampling wants them
+    juce::AudioBuffer<SampleType> channelBuffer;
+};
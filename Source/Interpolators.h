@@ -0,0 +1,288 @@
+/*
+  ==============================================================================
+
+    Interpolators.h
+    Created: 17 Oct 2026 11:02:41am
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Kernels.h"
+
+/*
+  Interpolation policies for DelayLine.
+
+  Each interpolator looks at numTaps consecutive samples around the read
+  position. The taps are passed oldest first: tap 0 is the oldest sample and
+  tap numTaps - 1 the newest. newerTaps is the number of taps that are newer
+  than the sample at the integer part of the delay. The fraction (0 - 1) moves
+  the read position from that sample towards the next older one.
+
+  interpolate() handles a single read, with the taps `stride` samples apart.
+  interpolateBlock() handles numValues reads at once, laid out as interleaved
+  frames of numChannels. Tap k of read j is taps[k * tapStride + j].
+
+  The policies are templated on the sample type of the delay line. The
+  fractions are always float, since they only position the read.
+*/
+
+// No interpolation, simply truncates the delay to a whole number of samples.
+template<typename SampleType>
+struct NoInterpolation
+{
+    static constexpr int numTaps = 1;
+    static constexpr int newerTaps = 0;
+
+    SampleType interpolate(const SampleType* taps, [[maybe_unused]] int stride,
+                           [[maybe_unused]] float fraction, [[maybe_unused]] int channel) noexcept
+    {
+        return taps[0];
+    }
+
+    void interpolateBlock(const SampleType* taps, [[maybe_unused]] int tapStride,
+                          [[maybe_unused]] const float* fraction, SampleType* output,
+                          int numValues, [[maybe_unused]] int numChannels) noexcept
+    {
+        for (int j = 0; j < numValues; ++j) {
+            output[j] = taps[j];
+        }
+    }
+};
+
+template<typename SampleType>
+struct LinearInterpolation
+{
+    static constexpr int numTaps = 2;
+    static constexpr int newerTaps = 0;
+
+    SampleType interpolate(const SampleType* taps, int stride, float fraction,
+                           [[maybe_unused]] int channel) noexcept
+    {
+        SampleType older = taps[0];
+        SampleType newer = taps[stride];
+        return newer + (older - newer) * SampleType(fraction);
+    }
+
+    void interpolateBlock(const SampleType* taps, int tapStride, const float* fraction,
+                          SampleType* output, int numValues, [[maybe_unused]] int numChannels) noexcept
+    {
+        const SampleType* older = taps;
+        const SampleType* newer = taps + tapStride;
+
+        for (int j = 0; j < numValues; ++j) {
+            output[j] = newer[j] + (older[j] - newer[j]) * SampleType(fraction[j]);
+        }
+    }
+};
+
+// 4-point, 3rd-order Hermite interpolation.
+template<typename SampleType>
+struct HermiteInterpolation
+{
+    static constexpr int numTaps = 4;
+    static constexpr int newerTaps = 1;
+
+    SampleType interpolate(const SampleType* taps, int stride, float fraction,
+                           [[maybe_unused]] int channel) noexcept
+    {
+        SampleType sampleA = taps[3 * stride];
+        SampleType sampleB = taps[2 * stride];
+        SampleType sampleC = taps[stride];
+        SampleType sampleD = taps[0];
+        SampleType f = SampleType(fraction);
+
+        SampleType slope0 = (sampleC - sampleA) * SampleType(0.5);
+        SampleType slope1 = (sampleD - sampleB) * SampleType(0.5);
+        SampleType v = sampleB - sampleC;
+        SampleType w = slope0 + v;
+        SampleType a = w + v + slope1;
+        SampleType b = w + a;
+        SampleType stage1 = a * f - b;
+        SampleType stage2 = stage1 * f + slope0;
+
+        return stage2 * f + sampleB;
+    }
+
+    // The block version is one of the kernels that are compiled for several
+    // instruction sets, see Kernels.h.
+    void interpolateBlock(const SampleType* taps, int tapStride, const float* fraction,
+                          SampleType* output, int numValues, [[maybe_unused]] int numChannels) noexcept
+    {
+        getKernels().get<SampleType>().hermite(taps, tapStride, fraction, output, numValues);
+    }
+};
+
+// 6-point, 5th-order Lagrange interpolation.
+template<typename SampleType>
+struct LagrangeInterpolation
+{
+    static constexpr int numTaps = 6;
+    static constexpr int newerTaps = 2;
+
+    SampleType interpolate(const SampleType* taps, int stride, float fraction,
+                           [[maybe_unused]] int channel) noexcept
+    {
+        SampleType weights[numTaps];
+        calculateWeights(SampleType(fraction), weights);
+
+        SampleType sum = 0;
+        for (int k = 0; k < numTaps; ++k) {
+            sum += taps[k * stride] * weights[k];
+        }
+        return sum;
+    }
+
+    void interpolateBlock(const SampleType* taps, int tapStride, const float* fraction,
+                          SampleType* output, int numValues, [[maybe_unused]] int numChannels) noexcept
+    {
+        for (int j = 0; j < numValues; ++j) {
+            SampleType weights[numTaps];
+            calculateWeights(SampleType(fraction[j]), weights);
+
+            SampleType sum = 0;
+            for (int k = 0; k < numTaps; ++k) {
+                sum += taps[k * tapStride + j] * weights[k];
+            }
+            output[j] = sum;
+        }
+    }
+
+private:
+    // Tap k sits at position 3 - k relative to the integer delay. The weight
+    // of a tap is the product of (fraction - position) over all other taps,
+    // divided by these constants.
+    static constexpr SampleType inverseDenominators[numTaps] = {
+        SampleType(1.0 / 120.0), SampleType(-1.0 / 24.0), SampleType(1.0 / 12.0),
+        SampleType(-1.0 / 12.0), SampleType(1.0 / 24.0), SampleType(-1.0 / 120.0),
+    };
+
+    static void calculateWeights(SampleType fraction, SampleType* weights) noexcept
+    {
+        SampleType distance[numTaps];
+        for (int k = 0; k < numTaps; ++k) {
+            distance[k] = fraction - SampleType(3 - k);
+        }
+
+        // prefix and suffix products avoid dividing by a zero distance
+        SampleType prefix = 1;
+        for (int k = 0; k < numTaps; ++k) {
+            weights[k] = prefix;
+            prefix *= distance[k];
+        }
+
+        SampleType suffix = 1;
+        for (int k = numTaps - 1; k >= 0; --k) {
+            weights[k] *= suffix * inverseDenominators[k];
+            suffix *= distance[k];
+        }
+    }
+};
+
+// First-order Thiran allpass. This has a flat magnitude response, which suits
+// fixed delay times, but it is recursive and so keeps state per channel.
+template<typename SampleType>
+struct ThiranInterpolation
+{
+    static constexpr int numTaps = 2;
+    static constexpr int newerTaps = 1;
+    static constexpr int maxChannels = 16;
+
+    void reset() noexcept
+    {
+        std::fill(std::begin(state), std::end(state), SampleType(0));
+    }
+
+    SampleType interpolate(const SampleType* taps, int stride, float fraction, int channel) noexcept
+    {
+        // The allpass delays the newer tap by 1 + fraction, which keeps its
+        // coefficient between -1/3 and 0, well away from the unstable region.
+        SampleType f = SampleType(fraction);
+        SampleType coeff = -f / (SampleType(2) + f);
+        SampleType older = taps[0];
+        SampleType newer = taps[stride];
+
+        SampleType output = coeff * (newer - state[channel]) + older;
+        state[channel] = output;
+        return output;
+    }
+
+    void interpolateBlock(const SampleType* taps, int tapStride, const float* fraction,
+                          SampleType* output, int numValues, int numChannels) noexcept
+    {
+        for (int j = 0; j < numValues; ++j) {
+            output[j] = interpolate(taps + j, tapStride, fraction[j], j % numChannels);
+        }
+    }
+
+private:
+    SampleType state[maxChannels] = {};
+};
+
+// 8-point windowed sinc, using a polyphase table of Blackman-windowed sinc
+// kernels. Neighbouring phases are interpolated linearly.
+template<typename SampleType>
+struct SincInterpolation
+{
+    static constexpr int numTaps = 8;
+    static constexpr int newerTaps = 3;
+    static constexpr int numPhases = 256;
+
+    SincInterpolation()
+    {
+        constexpr double pi = juce::MathConstants<double>::pi;
+        constexpr double halfWidth = numTaps / 2;
+
+        for (int phase = 0; phase <= numPhases; ++phase) {
+            double fraction = double(phase) / numPhases;
+            double weights[numTaps];
+            double sum = 0.0;
+
+            for (int k = 0; k < numTaps; ++k) {
+                double x = double(numTaps - newerTaps - 1 - k) - fraction;
+                double sinc = (x == 0.0) ? 1.0 : std::sin(pi * x) / (pi * x);
+                double window = 0.42 + 0.5 * std::cos(pi * x / halfWidth)
+                                     + 0.08 * std::cos(2.0 * pi * x / halfWidth);
+                weights[k] = sinc * window;
+                sum += weights[k];
+            }
+
+            // normalize for unity gain at DC
+            for (int k = 0; k < numTaps; ++k) {
+                table[size_t(phase)][size_t(k)] = SampleType(weights[k] / sum);
+            }
+        }
+    }
+
+    SampleType interpolate(const SampleType* taps, int stride, float fraction,
+                           [[maybe_unused]] int channel) noexcept
+    {
+        float position = fraction * float(numPhases);
+        int phase = int(position);
+        SampleType t = SampleType(position - float(phase));
+
+        const auto& kernel0 = table[size_t(phase)];
+        const auto& kernel1 = table[size_t(phase + 1)];
+
+        SampleType sum = 0;
+        for (int k = 0; k < numTaps; ++k) {
+            SampleType weight = kernel0[size_t(k)] + (kernel1[size_t(k)] - kernel0[size_t(k)]) * t;
+            sum += taps[k * stride] * weight;
+        }
+        return sum;
+    }
+
+    void interpolateBlock(const SampleType* taps, int tapStride, const float* fraction,
+                          SampleType* output, int numValues, [[maybe_unused]] int numChannels) noexcept
+    {
+        for (int j = 0; j < numValues; ++j) {
+            output[j] = interpolate(taps + j, tapStride, fraction[j], 0);
+        }
+    }
+
+private:
+    std::array<std::array<SampleType, numTaps>, numPhases + 1> table;
+};
@@ -0,0 +1,233 @@
+/*
+  ==============================================================================
+
+    Kernels.cpp
+    Created: 17 Oct 2026 8:20:14pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Kernels.h"
+
+// The generic kernels are always inlined into the wrappers below, so that
+// each copy gets compiled for the instruction set of its wrapper.
+#if JUCE_INTEL && (JUCE_GCC || JUCE_CLANG)
+ #define DELAYDSP_MULTI_ISA 1
+ #define DELAYDSP_TARGET(isa) __attribute__((target(isa)))
+#else
+ #define DELAYDSP_MULTI_ISA 0
+#endif
+
+namespace
+{
+
+template<typename SampleType>
+forcedinline void hermiteKernel(const SampleType* taps, int tapStride, const float* fraction,
+                                SampleType* output, int numValues) noexcept
+{
+    const SampleType* sampleA = taps + 3 * tapStride;
+    const SampleType* sampleB = taps + 2 * tapStride;
+    const SampleType* sampleC = taps + tapStride;
+    const SampleType* sampleD = taps;
+    
+    for (int j = 0; j < numValues; ++j) {
+        SampleType a = sampleA[j];
+        SampleType b = sampleB[j];
+        SampleType c = sampleC[j];
+        SampleType d = sampleD[j];
+        SampleType f = SampleType(fraction[j]);
+        
+        SampleType slope0 = (c - a) * SampleType(0.5);
+        SampleType slope1 = (d - b) * SampleType(0.5);
+        SampleType v = b - c;
+        SampleType w = slope0 + v;
+        SampleType p = w + v + slope1;
+        SampleType q = w + p;
+        SampleType stage1 = p * f - q;
+        SampleType stage2 = stage1 * f + slope0;
+        
+        output[j] = stage2 * f + b;
+    }
+}
+
+// Raises the peak to the largest absolute value and adds the squares to the sum.
+template<typename SampleType>
+forcedinline void measureKernel(const SampleType* data, int numSamples,
+                                SampleType& peak, SampleType& sumSquares) noexcept
+{
+    // A running maximum or sum is a reduction that compilers won't vectorize
+    // without fast-math, but element-wise ones over a fixed number of lanes
+    // they will.
+    constexpr int numLanes = 16;
+    SampleType maxLanes[numLanes] = {};
+    SampleType sumLanes[numLanes] = {};
+    
+    int i = 0;
+    for (; i + numLanes <= numSamples; i += numLanes) {
+        for (int k = 0; k < numLanes; ++k) {
+            maxLanes[k] = std::max(maxLanes[k], std::abs(data[i + k]));
+            sumLanes[k] += data[i + k] * data[i + k];
+        }
+    }
+    for (; i < numSamples; ++i) {
+        maxLanes[0] = std::max(maxLanes[0], std::abs(data[i]));
+        sumLanes[0] += data[i] * data[i];
+    }
+    for (int k = 0; k < numLanes; ++k) {
+        peak = std::max(peak, maxLanes[k]);
+        sumSquares += sumLanes[k];
+    }
+}
+
+template<typename SampleType>
+forcedinline void mixStereoKernel(SampleType* left, SampleType* right, const SampleType* wet,
+                                  const SampleType* taps, const float* mix, const float* gain,
+                                  int numSamples, SampleType& peakL, SampleType& peakR,
+                                  SampleType& sumSquaresL, SampleType& sumSquaresR) noexcept
+{
+    for (int i = 0; i < numSamples; ++i) {
+        SampleType m = SampleType(mix[i]);
+        SampleType g = SampleType(gain[i]);
+        left[i] = (left[i] + (wet[2*i] + taps[2*i]) * m) * g;
+        right[i] = (right[i] + (wet[2*i + 1] + taps[2*i + 1]) * m) * g;
+    }
+    
+    measureKernel(left, numSamples, peakL, sumSquaresL);
+    measureKernel(right, numSamples, peakR, sumSquaresR);
+}
+
+template<typename SampleType>
+forcedinline void mixChannelsKernel(SampleType* const* channels, int numChannels,
+                                    const SampleType* wet, const SampleType* taps,
+                                    const float* mix, const float* gain, int numSamples,
+                                    SampleType& peak, SampleType& sumSquares) noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel) {
+        SampleType* output = channels[channel];
+        const SampleType* channelWet = wet + channel;
+        const SampleType* channelTaps = taps + channel;
+        
+        for (int i = 0; i < numSamples; ++i) {
+            int j = i * numChannels;
+            output[i] = (output[i] + (channelWet[j] + channelTaps[j]) * SampleType(mix[i]))
+                      * SampleType(gain[i]);
+        }
+        
+        measureKernel(output, numSamples, peak, sumSquares);
+    }
+}
+
+template<typename SampleType>
+forcedinline void crossfadeKernel(SampleType* output, const SampleType* dry, const float* fade,
+                                  int numSamples, SampleType& peak, SampleType& sumSquares) noexcept
+{
+    for (int i = 0; i < numSamples; ++i) {
+        output[i] += (dry[i] - output[i]) * SampleType(fade[i]);
+    }
+    
+    measureKernel(output, numSamples, peak, sumSquares);
+}
+
+forcedinline void encodeHalfKernel(const float* input, uint16_t* output, int numValues) noexcept
+{
+    for (int i = 0; i < numValues; ++i) {
+        output[i] = floatToHalf(input[i]);
+    }
+}
+
+forcedinline void decodeHalfKernel(const uint16_t* input, float* output, int numValues) noexcept
+{
+    for (int i = 0; i < numValues; ++i) {
+        output[i] = halfToFloat(input[i]);
+    }
+}
+
+// Defines the kernels for one instruction set, with the given function
+// attributes, plus a Kernels table that points to the float and double
+// versions of them.
+#define DELAYDSP_DEFINE_KERNELS(suffix, attributes, isaName)                                 \
+    template<typename T>                                                                     \
+    attributes void hermite##suffix(const T* taps, int tapStride, const float* fraction,     \
+                                    T* output, int numValues) noexcept                       \
+    {                                                                                        \
+        hermiteKernel(taps, tapStride, fraction, output, numValues);                         \
+    }                                                                                        \
+                                                                                             \
+    template<typename T>                                                                     \
+    attributes void mixStereo##suffix(T* left, T* right, const T* wet, const T* taps,        \
+                                      const float* mix, const float* gain, int numSamples,   \
+                                      T& peakL, T& peakR,                                    \
+                                      T& sumSquaresL, T& sumSquaresR) noexcept               \
+    {                                                                                        \
+        mixStereoKernel(left, right, wet, taps, mix, gain, numSamples,                       \
+                        peakL, peakR, sumSquaresL, sumSquaresR);                             \
+    }                                                                                        \
+                                                                                             \
+    template<typename T>                                                                     \
+    attributes void mixChannels##suffix(T* const* channels, int numChannels,                 \
+                                        const T* wet, const T* taps,                         \
+                                        const float* mix, const float* gain, int numSamples, \
+                                        T& peak, T& sumSquares) noexcept                     \
+    {                                                                                        \
+        mixChannelsKernel(channels, numChannels, wet, taps, mix, gain, numSamples,           \
+                          peak, sumSquares);                                                 \
+    }                                                                                        \
+                                                                                             \
+    template<typename T>                                                                     \
+    attributes void crossfade##suffix(T* output, const T* dry, const float* fade,            \
+                                      int numSamples, T& peak, T& sumSquares) noexcept       \
+    {                                                                                        \
+        crossfadeKernel(output, dry, fade, numSamples, peak, sumSquares);                    \
+    }                                                                                        \
+                                                                                             \
+    attributes void encodeHalf##suffix(const float* input, uint16_t* output,                 \
+                                       int numValues) noexcept                               \
+    {                                                                                        \
+        encodeHalfKernel(input, output, numValues);                                          \
+    }                                                                                        \
+                                                                                             \
+    attributes void decodeHalf##suffix(const uint16_t* input, float* output,                 \
+                                       int numValues) noexcept                               \
+    {                                                                                        \
+        decodeHalfKernel(input, output, numValues);                                          \
+    }                                                                                        \
+                                                                                             \
+    const Kernels kernels##suffix {                                                          \
+        { hermite##suffix<float>, mixStereo##suffix<float>, mixChannels##suffix<float>,      \
+          crossfade##suffix<float> },                                                        \
+        { hermite##suffix<double>, mixStereo##suffix<double>, mixChannels##suffix<double>,   \
+          crossfade##suffix<double> },                                                       \
+        encodeHalf##suffix, decodeHalf##suffix,                                              \
+        isaName                                                                              \
+    };
+
+DELAYDSP_DEFINE_KERNELS(Generic, , "generic")
+
+#if DELAYDSP_MULTI_ISA
+DELAYDSP_DEFINE_KERNELS(SSE2, DELAYDSP_TARGET("sse2"), "sse2")
+DELAYDSP_DEFINE_KERNELS(AVX2, DELAYDSP_TARGET("avx2,fma"), "avx2")
+DELAYDSP_DEFINE_KERNELS(AVX512, DELAYDSP_TARGET("avx512f"), "avx512")
+#endif
+
+const Kernels& selectKernels() noexcept
+{
+   #if DELAYDSP_MULTI_ISA
+    if (juce::SystemStats::hasAVX512F()) { return kernelsAVX512; }
+    if (juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3()) { return kernelsAVX2; }
+    if (juce::SystemStats::hasSSE2()) { return kernelsSSE2; }
+   #endif
+    return kernelsGeneric;
+}
+
+// Picked when the plug-in is loaded. Doing it on first use would query the
+// CPU, which may read from /proc, from inside processBlock.
+const Kernels& selectedKernels = selectKernels();
+
+} // namespace
+
+const Kernels& getKernels() noexcept
+{
+    return selectedKernels;
+}
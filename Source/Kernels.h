@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    Kernels.h
+    Created: 17 Oct 2026 8:20:14pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/*
+  The hottest loops of the plug-in. Kernels.cpp compiles each of them several
+  times, once for every instruction set level, and getKernels() picks the
+  best version for the CPU at runtime. The kernels are plain loops that the
+  compiler vectorizes for the instruction set it targets.
+
+  Only the loops in this table are dispatched. The delay line's gather and
+  write loops, the linear, Lagrange and sinc interpolators and the feedback
+  filter loop are built for the baseline instruction set only.
+*/
+template<typename SampleType>
+struct KernelTable
+{
+    // 4-point Hermite interpolation, see HermiteInterpolation.
+    void (*hermite)(const SampleType* taps, int tapStride, const float* fraction,
+                    SampleType* output, int numValues) noexcept;
+    
+    // Mixes the interleaved stereo wet signal and taps into the dry signal and
+    // applies the output gain, in place: left and right hold the dry signal
+    // and get overwritten with the output. They must not overlap. The peaks
+    // are raised to the largest absolute output value, and the squares of
+    // the output are added to the sums.
+    void (*mixStereo)(SampleType* left, SampleType* right, const SampleType* wet,
+                      const SampleType* taps, const float* mix, const float* gain, int numSamples,
+                      SampleType& peakL, SampleType& peakR,
+                      SampleType& sumSquaresL, SampleType& sumSquaresR) noexcept;
+    
+    // The same for any number of channels, with wet and taps holding
+    // interleaved frames of numChannels. The peak and the sum of squares
+    // are taken over all channels together.
+    void (*mixChannels)(SampleType* const* channels, int numChannels, const SampleType* wet,
+                        const SampleType* taps, const float* mix, const float* gain, int numSamples,
+                        SampleType& peak, SampleType& sumSquares) noexcept;
+    
+    // Fades one channel of output towards the dry signal, in place. A fade
+    // of 0 keeps the output and 1 gives only the dry signal. The result is
+    // measured like in the mix kernels.
+    void (*crossfade)(SampleType* output, const SampleType* dry, const float* fade, int numSamples,
+                      SampleType& peak, SampleType& sumSquares) noexcept;
+};
+
+// Every kernel exists for both sample types, since the plug-in processes in
+// double precision when the host asks for it. The smoothed parameters that
+// the kernels read are float either way.
+struct Kernels
+{
+    KernelTable<float> forFloat;
+    KernelTable<double> forDouble;
+    
+    // Block versions of floatToHalf() and halfToFloat() below.
+    void (*encodeHalf)(const float* input, uint16_t* output, int numValues) noexcept;
+    void (*decodeHalf)(const uint16_t* input, float* output, int numValues) noexcept;
+    
+    const char* name;
+    
+    template<typename SampleType>
+    const KernelTable<SampleType>& get() const noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>) {
+            return forDouble;
+        } else {
+            return forFloat;
+        }
+    }
+};
+
+const Kernels& getKernels() noexcept;
+
+/*
+  Conversion between float and IEEE 754 half precision, for the compact
+  storage of DelayLine. Both are branch-free, so that the block kernels
+  vectorize. Rounding is to nearest, ties to even.
+
+  Below 65520 in magnitude, floatToHalf() matches the hardware conversion
+  bit for bit. From there up, the hardware gives infinity, while this clamps
+  to the largest half, 65504: an infinity stored in the delay line would
+  turn the feedback loop into NaN. Infinity and NaN clamp the same way.
+*/
+inline uint16_t floatToHalf(float value) noexcept
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    
+    // The clamping to 65504 and the comparisons are done on the bits, which
+    // order the same way as positive floats.
+    uint32_t magnitudeBits = std::min(bits & 0x7fffffffu, 0x477fe000u);
+    
+    // Normal halves: rebias the exponent from 127 to 15 and round off the
+    // 13 mantissa bits that don't fit.
+    uint32_t normal = (magnitudeBits - (112u << 23) + 0x0fffu + ((magnitudeBits >> 13) & 1u)) >> 13;
+    
+    // Below 2^-14 the half is subnormal, in steps of 2^-24. Adding 0.5 has
+    // the FPU round the magnitude to that step, into the low mantissa bits.
+    float magnitude;
+    std::memcpy(&magnitude, &magnitudeBits, sizeof(magnitude));
+    float shifted = magnitude + 0.5f;
+    uint32_t shiftedBits;
+    std::memcpy(&shiftedBits, &shifted, sizeof(shiftedBits));
+    uint32_t subnormal = shiftedBits - 0x3f000000u;
+    
+    // Select with a mask rather than a branch.
+    uint32_t isSubnormal = 0u - uint32_t(magnitudeBits < 0x38800000u);
+    return uint16_t(sign | (subnormal & isSubnormal) | (normal & ~isSubnormal));
+}
+
+inline float halfToFloat(uint16_t half) noexcept
+{
+    uint32_t sign = uint32_t(half & 0x8000u) << 16;
+    uint32_t magnitude = half & 0x7fffu;
+    
+    // Subnormal halves are converted through an integer rather than by
+    // rebiasing, since float denormals may be flushed to zero.
+    uint32_t normal = (magnitude << 13) + (112u << 23);
+    float subnormalValue = float(int32_t(magnitude)) * 5.9604644775390625e-8f;
+    uint32_t subnormal;
+    std::memcpy(&subnormal, &subnormalValue, sizeof(subnormal));
+    
+    uint32_t isSubnormal = 0u - uint32_t(magnitude < 0x0400u);
+    uint32_t bits = sign | (subnormal & isSubnormal) | (normal & ~isSubnormal);
+    
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
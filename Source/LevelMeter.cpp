@@ -11,12 +11,10 @@
 #include "LevelMeter.h"
 #include "LookAndFeel.h"
 
-LevelMeter::LevelMeter(Measurement& measurementL_, Measurement& measurementR_)
-    : measurementL(measurementL_), measurementR(measurementR_), dbLevelL(clampdB), dbLevelR(clampdB)
+LevelMeter::LevelMeter(Measurement& measurement_) : measurement(measurement_)
 {
     setOpaque(true);
     startTimerHz(refreshRate);
-    decay = 1.0f - std::exp(-1.0f / (float(refreshRate) * 0.2f));
 }
 
 //chatgpt
@@ -24,18 +22,106 @@ LevelMeter::~LevelMeter() = default;
 
 void LevelMeter::timerCallback()
 {
-    updateLevel(measurementL.readAndReset(), levelL, dbLevelL);
-    updateLevel(measurementR.readAndReset(), levelR, dbLevelR);
-    repaint();
+    // Apply the ballistics block by block, so the meter moves the same way
+    // no matter how late the timer fires.
+    float sampleRate = float(measurement.getSampleRate());
+    bool receivedAudio = false;
+    
+    measurement.drain([&](const LevelRecord& record) {
+        float seconds = float(record.numSamples) / sampleRate;
+        updateLevel(left, record.peakL, record.rmsL, seconds);
+        updateLevel(right, record.peakR, record.rmsR, seconds);
+        receivedAudio = true;
+    });
+    
+    // nothing is playing, let the meter fall
+    if (!receivedAudio) {
+        float seconds = float(getTimerInterval()) / 1000.0f;
+        updateLevel(left, 0.0f, 0.0f, seconds);
+        updateLevel(right, 0.0f, 0.0f, seconds);
+    }
+    
+    updateDecibels(left);
+    updateDecibels(right);
+    repaintChannel(left, 0, 7);
+    repaintChannel(right, 9, 7);
+    
+    // Poll less often while there is nothing to show. Records that arrive
+    // in the meantime wait in the queue, so nothing is missed.
+    bool silent = left.dbHoldLevel <= clampdB && right.dbHoldLevel <= clampdB;
+    if (silent != idle) {
+        idle = silent;
+        startTimerHz(idle ? idleRefreshRate : refreshRate);
+    }
+}
+
+void LevelMeter::repaintChannel(Channel& channel, int x, int width)
+{
+    // Only the part of the bar between the old and new positions changes.
+    int barY = std::min(positionForLevel(channel.dbLevel), getHeight());
+    int holdY = std::min(positionForLevel(channel.dbHoldLevel), getHeight());
+    int rmsY = std::min(positionForLevel(channel.dbRms), getHeight());
+    
+    if (barY != channel.barY) {
+        int top = std::min(barY, channel.barY);
+        repaint(x, top, width, std::max(barY, channel.barY) - top);
+        channel.barY = barY;
+    }
+    if (holdY != channel.holdY) {
+        repaint(x, channel.holdY, width, 2);
+        repaint(x, holdY, width, 2);
+        channel.holdY = holdY;
+    }
+    if (rmsY != channel.rmsY) {
+        int top = std::min(rmsY, channel.rmsY);
+        repaint(x, top, width, std::max(rmsY, channel.rmsY) - top);
+        channel.rmsY = rmsY;
+    }
 }
 
 
 void LevelMeter::paint (juce::Graphics& g)
 {
-    const auto bounds = getLocalBounds();
+    // The editor may have moved to another display since the scale was drawn.
+    float scaleFactor = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (scaleFactor != scaleImageFactor) {
+        drawScale(scaleFactor);
+    }
+    
     g.fillAll(Colors::LevelMeter::background);
-    drawLevel(g, dbLevelL, 0, 7);
-    drawLevel(g, dbLevelR, 9, 7);
+    drawLevel(g, left, 0, 7);
+    drawLevel(g, right, 9, 7);
+    g.drawImage(scale, getLocalBounds().toFloat());
+}
+    
+void LevelMeter::resized()
+{
+    maxPos = 4.0f;
+    minPos = float(getHeight()) - 4.0f;
+    
+    drawScale(juce::Component::getApproximateScaleFactorForComponent(this));
+    
+    left.barY = left.holdY = left.rmsY = getHeight();
+    right.barY = right.holdY = right.rmsY = getHeight();
+}
+
+void LevelMeter::drawScale(float scaleFactor)
+{
+    scaleImageFactor = scaleFactor;
+    
+    const auto bounds = getLocalBounds();
+    if (bounds.isEmpty()) {
+        scale = {};
+        return;
+    }
+    
+    // render at the display's pixel density, so the labels stay sharp
+    scale = juce::Image(juce::Image::ARGB,
+                        juce::roundToInt(float(bounds.getWidth()) * scaleFactor),
+                        juce::roundToInt(float(bounds.getHeight()) * scaleFactor), true);
+    
+    juce::Graphics g(scale);
+    g.addTransform(juce::AffineTransform::scale(scaleFactor));
     
     g.setFont(Fonts::getFont(10.0f));
     for (float db = maxdB; db >= mindB; db -= stepdB) {
@@ -49,16 +135,11 @@ void LevelMeter::paint (juce::Graphics& g)
                              juce::Justification::right);
     }
 }
-    
-void LevelMeter::resized()
-{
-    maxPos = 4.0f;
-    minPos = float(getHeight()) - 4.0f;
-}
 
 
-void LevelMeter::drawLevel(juce::Graphics& g, float level, int x, int width)
+void LevelMeter::drawLevel(juce::Graphics& g, const Channel& channel, int x, int width)
 {
+    float level = channel.dbLevel;
     int y = positionForLevel(level);
     if (level > 0.0f) {
         int y0 = positionForLevel(0.0f);
@@ -70,19 +151,53 @@ void LevelMeter::drawLevel(juce::Graphics& g, float level, int x, int width)
         g.setColour(Colors::LevelMeter::levelOK);
         g.fillRect(x, y, width, getHeight() - y);
     }
+    
+    // The average level is a darker bar inside the peak bar.
+    int rmsY = std::max(positionForLevel(channel.dbRms), y);
+    if (rmsY < getHeight()) {
+        g.setColour(Colors::LevelMeter::rms);
+        g.fillRect(x, rmsY, width, getHeight() - rmsY);
+    }
+    
+    int holdY = positionForLevel(channel.dbHoldLevel);
+    if (holdY < getHeight()) {
+        g.setColour(channel.dbHoldLevel > 0.0f ? Colors::LevelMeter::tooLoud
+                                               : Colors::LevelMeter::levelOK);
+        g.fillRect(x, holdY, width, 2);
+    }
 }
 
-void LevelMeter::updateLevel(float newLevel, float& smoothedLevel, float& leveldB) const
+void LevelMeter::updateLevel(Channel& channel, float newLevel, float newRms, float seconds) const
 {
-    if (newLevel > smoothedLevel) {
-        smoothedLevel = newLevel; // instantaneous attack
+    // The RMS is averaged as power, over a longer time than the peak falls.
+    float power = channel.rms * channel.rms;
+    power += (newRms * newRms - power) * (1.0f - std::exp(-seconds / rmsTime));
+    channel.rms = std::sqrt(power);
+    
+    if (newLevel > channel.level) {
+        channel.level = newLevel; // instantaneous attack
     } else {
-        smoothedLevel += (newLevel - smoothedLevel) * decay;
+        float decay = 1.0f - std::exp(-seconds / releaseTime);
+        channel.level += (newLevel - channel.level) * decay;
     }
     
-    if (smoothedLevel > clampLevel) {
-        leveldB = juce::Decibels::gainToDecibels(smoothedLevel);
+    if (newLevel >= channel.holdLevel) {
+        channel.holdLevel = newLevel;
+        channel.holdTime = 0.0f;
     } else {
-        leveldB = clampdB;
+        channel.holdTime += seconds;
+        if (channel.holdTime > holdDuration) {
+            channel.holdLevel = channel.level;
+        }
     }
 }
+
+void LevelMeter::updateDecibels(Channel& channel) const
+{
+    auto toDecibels = [](float level) {
+        return level > clampLevel ? juce::Decibels::gainToDecibels(level) : clampdB;
+    };
+    channel.dbLevel = toDecibels(channel.level);
+    channel.dbHoldLevel = toDecibels(channel.holdLevel);
+    channel.dbRms = toDecibels(channel.rms);
+}
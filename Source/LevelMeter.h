@@ -16,7 +16,7 @@
 class LevelMeter : public juce::Component, private juce::Timer
 {
 public:
-    LevelMeter(Measurement& measurementL, Measurement& measurementR);
+    LevelMeter(Measurement& measurement);
     
     ~LevelMeter() override;
     
@@ -28,25 +28,51 @@ private:
     {
         return int(std::round(juce::jmap(dbLevel, maxdB, mindB, maxPos, minPos)));
     }
-    void drawLevel(juce::Graphics& g, float level, int x, int width);
+    struct Channel
+    {
+        float level;        // smoothed, linear
+        float dbLevel;
+        float holdLevel;    // highest recent peak, linear
+        float dbHoldLevel;
+        float holdTime;     // seconds since the peak was held
+        float rms = clampLevel;   // averaged, linear
+        float dbRms = clampdB;
+        int barY = 0;       // positions as last painted
+        int holdY = 0;
+        int rmsY = 0;
+    };
+    
+    void drawLevel(juce::Graphics& g, const Channel& channel, int x, int width);
+    void drawScale(float scaleFactor);
     void timerCallback() override;
-    void updateLevel(float newLevel, float& smoothedLevel, float& leveldB) const;
+    void updateLevel(Channel& channel, float newLevel, float newRms, float seconds) const;
+    void updateDecibels(Channel& channel) const;
+    void repaintChannel(Channel& channel, int x, int width);
     
-    Measurement& measurementL;
-    Measurement& measurementR;
+    Measurement& measurement;
     static constexpr float maxdB = 6.0f;
     static constexpr float mindB = -60.0f;
     static constexpr float stepdB = 6.0f;
     float maxPos = 0.0f;
     float minPos = 0.0f;
-    float dbLevelL;
-    float dbLevelR;
     static constexpr float clampdB = -120.0f;
     static constexpr float clampLevel = 0.000001f; // // -120 dB
     
     static constexpr int refreshRate = 60;
-    float decay = 0.0f;
-    float levelL = clampLevel; float levelR = clampLevel;
+    static constexpr int idleRefreshRate = 10;  // while both channels are silent
+    bool idle = false;
+    static constexpr float releaseTime = 0.2f;   // seconds
+    static constexpr float holdDuration = 1.5f;  // seconds
+    static constexpr float rmsTime = 0.3f;       // seconds
+    
+    Channel left { clampLevel, clampdB, clampLevel, clampdB, 0.0f };
+    Channel right { clampLevel, clampdB, clampLevel, clampdB, 0.0f };
+    
+    // The tick lines and labels, drawn on top of the bars. They only change
+    // when the meter is resized or moves to a display with another pixel
+    // density.
+    juce::Image scale;
+    float scaleImageFactor = 0.0f;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeter)
 };
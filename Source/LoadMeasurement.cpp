@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    LoadMeasurement.cpp
+    Created: 17 Oct 2026 10:26:51pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#include "LoadMeasurement.h"
+
+void LoadMeasurement::prepare(double newSampleRate) noexcept
+{
+    sampleRate = newSampleRate;
+    secondsPerTick = 1.0 / double(juce::Time::getHighResolutionTicksPerSecond());
+    
+    // The clock speed is looked up here because it may read from /proc.
+    double cyclesPerSecond = double(juce::SystemStats::getCpuSpeedInMegahertz()) * 1.0e6;
+    cyclesPerSampleBudget.store(float(cyclesPerSecond / sampleRate));
+    
+    reset();
+}
+
+void LoadMeasurement::reset() noexcept
+{
+    averageLoad = 0.0f;
+    load.store(0.0f);
+    
+    for (auto& peak : peaks) {
+        peak.store(0.0f);
+    }
+    currentSlot = 0;
+    samplesInSlot = 0;
+}
+
+float LoadMeasurement::getPeakLoad() const noexcept
+{
+    float peakLoad = 0.0f;
+    for (const auto& peak : peaks) {
+        peakLoad = std::max(peakLoad, peak.load(std::memory_order_relaxed));
+    }
+    return peakLoad;
+}
+
+void LoadMeasurement::blockFinished(juce::int64 startTicks, int numSamples) noexcept
+{
+    if (numSamples <= 0 || sampleRate <= 0.0) { return; }
+    
+    double elapsed = double(juce::Time::getHighResolutionTicks() - startTicks) * secondsPerTick;
+    double budget = double(numSamples) / sampleRate;
+    float blockLoad = float(elapsed / budget);
+    
+    // One-pole average, weighted by how long the block lasts.
+    float coeff = float(std::min(1.0, budget / averageTime));
+    averageLoad += (blockLoad - averageLoad) * coeff;
+    load.store(averageLoad, std::memory_order_relaxed);
+    
+    auto& peak = peaks[currentSlot];
+    if (blockLoad > peak.load(std::memory_order_relaxed)) {
+        peak.store(blockLoad, std::memory_order_relaxed);
+    }
+    
+    // Move on to the next slot every second, which forgets the oldest one.
+    samplesInSlot += numSamples;
+    if (samplesInSlot >= int(sampleRate)) {
+        samplesInSlot = 0;
+        currentSlot = (currentSlot + 1) % peaks.size();
+        peaks[currentSlot].store(0.0f, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    LoadMeasurement.h
+    Created: 17 Oct 2026 10:26:51pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Measures how much of the real-time budget processBlock uses. The audio
+// thread times every block with a ScopedTimer, any other thread can read
+// the results. A load of 1.0 means a block took as long as it lasts.
+class LoadMeasurement
+{
+public:
+    struct ScopedTimer
+    {
+        ScopedTimer(LoadMeasurement& measurementToUse, int numSamplesToTime) noexcept
+            : measurement(measurementToUse), numSamples(numSamplesToTime),
+              startTicks(juce::Time::getHighResolutionTicks())
+        {
+        }
+        
+        ~ScopedTimer() noexcept
+        {
+            measurement.blockFinished(startTicks, numSamples);
+        }
+        
+        LoadMeasurement& measurement;
+        int numSamples;
+        juce::int64 startTicks;
+    };
+    
+    // Not for the audio thread. Also resets the measurement.
+    void prepare(double sampleRate) noexcept;
+    void reset() noexcept;
+    
+    // Average load, smoothed over about half a second.
+    float getLoad() const noexcept
+    {
+        return load.load(std::memory_order_relaxed);
+    }
+    
+    // The slowest block in the last peakWindowSeconds.
+    float getPeakLoad() const noexcept;
+    
+    // Average CPU cycles spent per sample, or 0 if the clock speed is unknown.
+    float getCyclesPerSample() const noexcept
+    {
+        return getLoad() * cyclesPerSampleBudget.load(std::memory_order_relaxed);
+    }
+    
+    static constexpr int peakWindowSeconds = 5;
+    
+private:
+    void blockFinished(juce::int64 startTicks, int numSamples) noexcept;
+    
+    static constexpr double averageTime = 0.5;
+    
+    std::atomic<float> load = 0.0f;
+    std::atomic<float> cyclesPerSampleBudget = 0.0f;
+    
+    // One slot for the peak of every second.
+    std::array<std::atomic<float>, peakWindowSeconds> peaks {};
+    
+    // only used by the audio thread
+    double sampleRate = 0.0;
+    double secondsPerTick = 0.0;
+    float averageLoad = 0.0f;
+    size_t currentSlot = 0;
+    int samplesInSlot = 0;
+};
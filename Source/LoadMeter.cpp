@@ -0,0 +1,53 @@
+/*
+  ==============================================================================
+
+    LoadMeter.cpp
+    Created: 17 Oct 2026 10:26:51pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#include "LoadMeter.h"
+#include "LookAndFeel.h"
+
+LoadMeter::LoadMeter(const LoadMeasurement& measurement_) : measurement(measurement_)
+{
+    setInterceptsMouseClicks(false, false);
+    startTimerHz(refreshRate);
+}
+
+LoadMeter::~LoadMeter() = default;
+
+void LoadMeter::timerCallback()
+{
+    float newLoad = measurement.getLoad();
+    float newPeakLoad = measurement.getPeakLoad();
+    float newCyclesPerSample = measurement.getCyclesPerSample();
+    
+    if (newLoad != load || newPeakLoad != peakLoad || newCyclesPerSample != cyclesPerSample) {
+        load = newLoad;
+        peakLoad = newPeakLoad;
+        cyclesPerSample = newCyclesPerSample;
+        repaint();
+    }
+}
+
+void LoadMeter::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds();
+    auto top = bounds.removeFromTop(bounds.getHeight() / 2);
+    
+    g.setFont(Fonts::getFont(10.0f));
+    
+    g.setColour(peakLoad > warningLoad ? Colors::LoadMeter::warning : Colors::LoadMeter::text);
+    g.drawText("DSP " + juce::String(load * 100.0f, 1) + "%  peak "
+               + juce::String(peakLoad * 100.0f, 1) + "%",
+               top, juce::Justification::centredLeft, false);
+    
+    if (cyclesPerSample > 0.0f) {
+        g.setColour(Colors::LoadMeter::text);
+        g.drawText(juce::String(juce::roundToInt(cyclesPerSample)) + " cycles/sample",
+                   bounds, juce::Justification::centredLeft, false);
+    }
+}
@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    LoadMeter.h
+    Created: 17 Oct 2026 10:26:51pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "LoadMeasurement.h"
+
+// Shows the DSP load of this instance as text: the average and peak
+// percentage of the real-time budget, and cycles per sample.
+class LoadMeter : public juce::Component, private juce::Timer
+{
+public:
+    LoadMeter(const LoadMeasurement& measurement);
+    
+    ~LoadMeter() override;
+    
+    void paint(juce::Graphics&) override;
+    
+private:
+    void timerCallback() override;
+    
+    const LoadMeasurement& measurement;
+    
+    float load = 0.0f;
+    float peakLoad = 0.0f;
+    float cyclesPerSample = 0.0f;
+    
+    // The peak is considered close to a dropout above this load.
+    static constexpr float warningLoad = 0.7f;
+    
+    static constexpr int refreshRate = 4;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoadMeter)
+};
@@ -50,35 +50,19 @@ void RotaryKnobLookAndFeel::drawRotarySlider( juce::Graphics& g, int x, int y, i
     auto bounds = juce::Rectangle<int>(x, y, width, width).toFloat();
     auto knobRect = bounds.reduced(10.0f, 10.0f);
     
-    auto path = juce::Path();
-    path.addEllipse(knobRect);
-    dropShadow.drawForPath(g, path);
-    
-    g.setColour(Colors::Knob::outline);
-    g.fillEllipse(knobRect);
+    float scaleFactor = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const auto& layer = getKnobLayer(width, scaleFactor, rotaryStartAngle, rotaryEndAngle);
+    g.drawImage(layer, bounds);
     
     auto innerRect = knobRect.reduced(2.0f, 2.0f);
-    auto gradient = juce::ColourGradient(
-        Colors::Knob::gradientTop, 0.0f, innerRect.getY(),
-        Colors::Knob::gradientBottom, 0.0f, innerRect.getBottom(), false);
-    g.setGradientFill(gradient);
-    g.fillEllipse(innerRect);
-    
     auto center = bounds.getCentre();
     auto radius = bounds.getWidth() / 2.0f;
     auto lineWidth = 3.0f;
     auto arcRadius = radius - lineWidth/2.0f;
     
-    juce::Path backgroundArc;
-    backgroundArc.addCentredArc(center.x, center.y, arcRadius, arcRadius,
-                                0.0f, rotaryStartAngle, rotaryEndAngle, true);
-    
     auto strokeType = juce::PathStrokeType(lineWidth, juce::PathStrokeType::curved,
                                            juce::PathStrokeType::rounded);
     
-    g.setColour(Colors::Knob::trackBackground);
-    g.strokePath(backgroundArc, strokeType);
-    
     auto dialRadius = innerRect.getHeight()/2.0f - lineWidth;
     auto toAngle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
     
@@ -111,6 +95,72 @@ void RotaryKnobLookAndFeel::drawRotarySlider( juce::Graphics& g, int x, int y, i
     }
 }
 
+const juce::Image& RotaryKnobLookAndFeel::getKnobLayer(int size, float scaleFactor,
+                                                       float rotaryStartAngle, float rotaryEndAngle)
+{
+    for (const auto& layer : knobLayers) {
+        if (layer.size == size && layer.scaleFactor == scaleFactor
+            && layer.rotaryStartAngle == rotaryStartAngle && layer.rotaryEndAngle == rotaryEndAngle) {
+            return layer.image;
+        }
+    }
+    
+    // Sizes only change when the editor is resized or moved to another
+    // display, so simply start over when there are too many.
+    if (int(knobLayers.size()) >= maxCachedLayers) {
+        knobLayers.clear();
+    }
+    
+    // render at the physical pixel size, so the cached layer is as sharp as
+    // drawing directly
+    int imageSize = std::max(1, juce::roundToInt(float(size) * scaleFactor));
+    juce::Image image(juce::Image::ARGB, imageSize, imageSize, true);
+    {
+        juce::Graphics g(image);
+        g.addTransform(juce::AffineTransform::scale(float(imageSize) / float(size)));
+        drawKnobLayer(g, juce::Rectangle<int>(0, 0, size, size).toFloat(),
+                      rotaryStartAngle, rotaryEndAngle);
+    }
+    
+    knobLayers.push_back({ size, scaleFactor, rotaryStartAngle, rotaryEndAngle, image });
+    return knobLayers.back().image;
+}
+
+void RotaryKnobLookAndFeel::drawKnobLayer(juce::Graphics& g, juce::Rectangle<float> bounds,
+                                          float rotaryStartAngle, float rotaryEndAngle)
+{
+    auto knobRect = bounds.reduced(10.0f, 10.0f);
+    
+    auto path = juce::Path();
+    path.addEllipse(knobRect);
+    dropShadow.drawForPath(g, path);
+    
+    g.setColour(Colors::Knob::outline);
+    g.fillEllipse(knobRect);
+    
+    auto innerRect = knobRect.reduced(2.0f, 2.0f);
+    auto gradient = juce::ColourGradient(
+        Colors::Knob::gradientTop, 0.0f, innerRect.getY(),
+        Colors::Knob::gradientBottom, 0.0f, innerRect.getBottom(), false);
+    g.setGradientFill(gradient);
+    g.fillEllipse(innerRect);
+    
+    auto center = bounds.getCentre();
+    auto radius = bounds.getWidth() / 2.0f;
+    auto lineWidth = 3.0f;
+    auto arcRadius = radius - lineWidth/2.0f;
+    
+    juce::Path backgroundArc;
+    backgroundArc.addCentredArc(center.x, center.y, arcRadius, arcRadius,
+                                0.0f, rotaryStartAngle, rotaryEndAngle, true);
+    
+    auto strokeType = juce::PathStrokeType(lineWidth, juce::PathStrokeType::curved,
+                                           juce::PathStrokeType::rounded);
+    
+    g.setColour(Colors::Knob::trackBackground);
+    g.strokePath(backgroundArc, strokeType);
+}
+
 
 
 
@@ -54,6 +54,13 @@ namespace Colors
         const juce::Colour tickLabel { 80, 80, 80 };
         const juce::Colour tooLoud { 226, 74, 81 };
         const juce::Colour levelOK { 65, 206, 88 };
+        const juce::Colour rms { 40, 150, 60 };
+    }
+
+    namespace LoadMeter
+    {
+        const juce::Colour text { 160, 155, 150 };
+        const juce::Colour warning { 226, 74, 81 };
     }
 }
 //==============================================================================
@@ -96,6 +103,26 @@ public:
     void fillTextEditorBackground(juce::Graphics&, int width, int height, juce::TextEditor&) override;
     
 private:
+    // The shadow, body and track of a knob don't depend on its value, so
+    // they are rendered once per size and kept here. Only the dial and the
+    // value arc are drawn on every repaint.
+    struct KnobLayer
+    {
+        int size;
+        float scaleFactor;
+        float rotaryStartAngle;
+        float rotaryEndAngle;
+        juce::Image image;
+    };
+    
+    const juce::Image& getKnobLayer(int size, float scaleFactor,
+                                    float rotaryStartAngle, float rotaryEndAngle);
+    void drawKnobLayer(juce::Graphics& g, juce::Rectangle<float> bounds,
+                       float rotaryStartAngle, float rotaryEndAngle);
+    
+    static constexpr int maxCachedLayers = 16;
+    std::vector<KnobLayer> knobLayers;
+    
     juce::DropShadow dropShadow { Colors::Knob::dropShadow, 6, { 0, 3 } };
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RotaryKnobLookAndFeel)
 };
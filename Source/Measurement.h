@@ -10,26 +10,97 @@
 
 #pragma once
 
-#include <atomic>
+#include <JuceHeader.h>
 
-struct Measurement
+// The output levels of one processBlock call.
+struct LevelRecord
 {
-    void reset() noexcept
+    float peakL = 0.0f;
+    float peakR = 0.0f;
+    float rmsL = 0.0f;
+    float rmsR = 0.0f;
+    juce::int64 position = 0;  // of the first sample, counted from prepareToPlay
+    int numSamples = 0;
+};
+
+/*
+  Wait-free single-producer, single-consumer queue of LevelRecords. The audio
+  thread pushes a record for every block and the editor drains them on its
+  timer, so every block reaches the meter.
+
+  When the editor stalls and the queue is full, new blocks are merged into a
+  pending record until there is room again. The meter then sees fewer but
+  longer blocks, but never misses a peak.
+*/
+class Measurement
+{
+public:
+    // Call from prepareToPlay, before the audio thread starts pushing. Drops
+    // the records of the previous run, which belong to another sample rate
+    // and position.
+    void prepare(double newSampleRate) noexcept
     {
-        value.store(0.0f);
+        sampleRate.store(newSampleRate);
+        fifo.reset();
+        pending = {};
+        hasPending = false;
     }
     
-    void updateIfGreater(float newValue) noexcept
+    // Audio thread only.
+    void push(const LevelRecord& record) noexcept
     {
-        auto oldValue = value.load();
-        while (newValue > oldValue &&
-               !value.compare_exchange_weak(oldValue, newValue));
+        if (hasPending) {
+            merge(pending, record);
+        } else {
+            pending = record;
+            hasPending = true;
+        }
+        
+        const auto scope = fifo.write(1);
+        if (scope.blockSize1 > 0) {
+            records[size_t(scope.startIndex1)] = pending;
+            hasPending = false;
+        }
     }
     
-    float readAndReset() noexcept
+    // Consumer thread only. Calls function for each waiting record, oldest first.
+    template<typename Function>
+    void drain(Function&& function)
     {
-        return value.exchange(0.0f);
+        const auto scope = fifo.read(fifo.getNumReady());
+        scope.forEach([&](int index) {
+            function(records[size_t(index)]);
+        });
     }
     
-    std::atomic<float> value;
+    double getSampleRate() const noexcept
+    {
+        return sampleRate.load();
+    }
+    
+    static constexpr int capacity = 512;
+    
+private:
+    static void merge(LevelRecord& into, const LevelRecord& record) noexcept
+    {
+        int numSamples = into.numSamples + record.numSamples;
+        if (numSamples > 0) {
+            float weightA = float(into.numSamples) / float(numSamples);
+            float weightB = float(record.numSamples) / float(numSamples);
+            into.rmsL = std::sqrt(into.rmsL * into.rmsL * weightA + record.rmsL * record.rmsL * weightB);
+            into.rmsR = std::sqrt(into.rmsR * into.rmsR * weightA + record.rmsR * record.rmsR * weightB);
+        }
+        into.peakL = std::max(into.peakL, record.peakL);
+        into.peakR = std::max(into.peakR, record.peakR);
+        into.numSamples = numSamples;
+    }
+    
+    juce::AbstractFifo fifo { capacity };
+    std::array<LevelRecord, capacity> records;
+    
+    std::atomic<double> sampleRate = 44100.0;
+    
+    // only used by the audio thread
+    LevelRecord pending;
+    bool hasPending = false;
 };
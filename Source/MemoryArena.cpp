@@ -0,0 +1,173 @@
+/*
+  ==============================================================================
+
+    MemoryArena.cpp
+    Created: 17 Oct 2026 11:52:06pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#include <cstring>
+#include <new>
+#include "MemoryArena.h"
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+#else
+ #include <sys/mman.h>
+ #include <unistd.h>
+#endif
+
+static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+static size_t roundUp(size_t numBytes, size_t multiple) noexcept
+{
+    return (numBytes + multiple - 1) / multiple * multiple;
+}
+
+static bool lockMemory(void* data, size_t numBytes) noexcept
+{
+   #if JUCE_WINDOWS
+    return VirtualLock(data, numBytes) != 0;
+   #else
+    return mlock(data, numBytes) == 0;
+   #endif
+}
+
+static void unlockMemory(void* data, size_t numBytes) noexcept
+{
+   #if JUCE_WINDOWS
+    VirtualUnlock(data, numBytes);
+   #else
+    munlock(data, numBytes);
+   #endif
+}
+
+MemoryArena::~MemoryArena()
+{
+    release();
+}
+
+void MemoryArena::reserve(size_t numBytes, bool lockPages)
+{
+    used = 0;
+    
+    if (numBytes > size) {
+        release();
+        allocatePages(numBytes);
+    }
+    
+    if (data == nullptr) {
+        jassert(numBytes == 0);
+        return;
+    }
+    
+    // Touching every page now faults it in. Fresh pages from the system are
+    // already zero, so this writes zeros, but the write is what counts.
+    std::memset(data, 0, size);
+    
+    if (lockPages && !locked) {
+        locked = lockMemory(data, size);
+    }
+}
+
+void MemoryArena::allocatePages(size_t numBytes) noexcept
+{
+   #if JUCE_WINDOWS
+    // Large pages on Windows need a privilege that plug-ins don't have.
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    size_t mappedSize = roundUp(numBytes, size_t(info.dwPageSize));
+    
+    if (void* ptr = VirtualAlloc(nullptr, mappedSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE)) {
+        data = ptr;
+        size = mappedSize;
+        return;
+    }
+   #else
+    size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    
+   #if JUCE_LINUX
+    // Explicit huge pages only exist if the administrator set some aside, so
+    // this usually fails. They are only asked for when rounding up to whole
+    // huge pages wastes little.
+    size_t hugeSize = roundUp(numBytes, hugePageSize);
+    if (numBytes >= hugePageSize && hugeSize - numBytes <= numBytes / 8) {
+        void* ptr = mmap(nullptr, hugeSize, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr != MAP_FAILED) {
+            data = ptr;
+            size = hugeSize;
+            hugePages = true;
+            return;
+        }
+    }
+   #endif
+    
+    size_t mappedSize = roundUp(numBytes, pageSize);
+    void* ptr = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr != MAP_FAILED) {
+        data = ptr;
+        size = mappedSize;
+        
+       #if JUCE_LINUX
+        // Transparent huge pages must be asked for before the pages are
+        // touched, or the kernel hands out normal ones. Only the aligned
+        // 2 MB stretches inside the mapping can get them.
+        if (size >= hugePageSize) {
+            hugePages = madvise(data, size, MADV_HUGEPAGE) == 0;
+        }
+       #endif
+        return;
+    }
+   #endif
+    
+    // The system has no pages to map, so fall back to the heap. The memory
+    // still gets pre-faulted and locked like mapped pages.
+    size_t heapSize = roundUp(numBytes, cacheLineSize);
+    if (void* heapData = ::operator new(heapSize, std::align_val_t(cacheLineSize), std::nothrow)) {
+        data = heapData;
+        size = heapSize;
+        fromHeap = true;
+    }
+}
+
+void MemoryArena::release() noexcept
+{
+    if (data != nullptr) {
+        if (fromHeap) {
+            if (locked) {
+                unlockMemory(data, size);
+            }
+            ::operator delete(data, std::align_val_t(cacheLineSize));
+        } else {
+           #if JUCE_WINDOWS
+            VirtualFree(data, 0, MEM_RELEASE);
+           #else
+            munmap(data, size);
+           #endif
+        }
+    }
+    
+    data = nullptr;
+    size = 0;
+    used = 0;
+    fromHeap = false;
+    hugePages = false;
+    locked = false;
+}
+
+void* MemoryArena::allocate(size_t numBytes, size_t alignment) noexcept
+{
+    jassert(juce::isPowerOfTwo(alignment));
+    
+    size_t start = roundUp(used, alignment);
+    if (data == nullptr || start + numBytes > size) {
+        jassertfalse;
+        return nullptr;
+    }
+    
+    used = start + numBytes;
+    return static_cast<char*>(data) + start;
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    MemoryArena.h
+    Created: 17 Oct 2026 11:52:06pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Lock the delay buffers into RAM so they can't be paged out. The lock is
+// tried, not required: if the system limit on locked memory is too low, the
+// buffers are simply not locked.
+#ifndef DELAYDSP_LOCK_DELAY_MEMORY
+ #define DELAYDSP_LOCK_DELAY_MEMORY 0
+#endif
+
+// Memory for the large buffers of the audio thread, taken straight from the
+// system in whole pages. On Linux it asks for explicit huge pages first and
+// falls back to transparent huge pages. If the system has no pages to give,
+// the memory comes from the heap instead.
+//
+// Every page is touched when the memory is reserved. The first write to a
+// page would otherwise fault on the audio thread, for example when the delay
+// time is raised into a part of the buffer that was never used before.
+//
+// The buffers are handed out one after the other with allocate(), so the
+// buffers of one owner sit next to each other in memory. The processor has
+// a single arena for all of them.
+class MemoryArena
+{
+public:
+    MemoryArena() = default;
+    ~MemoryArena();
+    
+    // Makes room for at least numBytes, zeroed. The memory is only replaced
+    // when it has to grow, but everything allocated so far is given up in
+    // either case. Not real-time safe.
+    void reserve(size_t numBytes, bool lockPages = false);
+    
+    void release() noexcept;
+    
+    // Returns the next numBytes of the arena, or nullptr if it is full.
+    void* allocate(size_t numBytes, size_t alignment = cacheLineSize) noexcept;
+    
+    template<typename Type>
+    Type* allocate(size_t count) noexcept
+    {
+        return static_cast<Type*>(allocate(count * sizeof(Type), std::max(alignof(Type), cacheLineSize)));
+    }
+    
+    size_t getSize() const noexcept
+    {
+        return size;
+    }
+    
+    bool isUsingHugePages() const noexcept
+    {
+        return hugePages;
+    }
+    
+    bool isLocked() const noexcept
+    {
+        return locked;
+    }
+    
+    static constexpr size_t cacheLineSize = 64;
+
+private:
+    // Sets data and size, or leaves them empty if there is no memory at all.
+    void allocatePages(size_t numBytes) noexcept;
+    
+    void* data = nullptr;
+    size_t size = 0;
+    size_t used = 0;
+    bool fromHeap = false;
+    bool hugePages = false;
+    bool locked = false;
+    
+    JUCE_DECLARE_NON_COPYABLE(MemoryArena)
+};
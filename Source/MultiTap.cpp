@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    MultiTap.cpp
+    Created: 17 Oct 2026 2:26:50pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#include "MultiTap.h"
+#include "DSP.h"
+
+template<typename SampleType>
+void MultiTap<SampleType>::prepareToPlay(double newSampleRate) noexcept
+{
+    sampleRate = newSampleRate;
+    
+    // The smoothing is updated once per sub-block, so the time constants
+    // are expressed in sub-blocks rather than samples. Like the main delay
+    // time, the tap times glide with a 200 ms time constant, the levels
+    // with 20 ms.
+    float blocksPerSecond = float(sampleRate) / float(DelayLine<SampleType>::maxBlockSize);
+    delayCoeff = 1.0f - std::exp(-1.0f / (0.2f * blocksPerSecond));
+    gainCoeff = 1.0f - std::exp(-1.0f / (0.02f * blocksPerSecond));
+}
+
+template<typename SampleType>
+void MultiTap<SampleType>::reset() noexcept
+{
+    delayInSamples.fill(0.0f);
+    gainL.fill(0.0f);
+    gainR.fill(0.0f);
+    
+    startDelay.fill(0.0f);
+    startGainL.fill(0.0f);
+    startGainR.fill(0.0f);
+    
+    targetGainL.fill(0.0f);
+    targetGainR.fill(0.0f);
+}
+
+template<typename SampleType>
+void MultiTap<SampleType>::update(const Parameters& params, const Tempo& tempo) noexcept
+{
+    for (size_t tap = 0; tap < maxTaps; ++tap) {
+        float delayTime = params.tempoSync
+            ? float(tempo.getMillisecondsForNoteLength(params.tapNote[tap]))
+            : params.tapTime[tap];
+        delayTime = std::clamp(delayTime, Parameters::minDelayTime, Parameters::maxDelayTime);
+        
+        targetDelay[tap] = delayTime / 1000.0f * float(sampleRate);
+        
+        // Jump straight to the delay time of a tap that is not playing yet.
+        if (startGainL[tap] + startGainR[tap] + gainL[tap] + gainR[tap] == 0.0f) {
+            delayInSamples[tap] = targetDelay[tap];
+            startDelay[tap] = targetDelay[tap];
+        }
+        
+        // Turning off multi-tap mode fades out the taps.
+        float level = params.multiTap ? params.tapLevel[tap] : 0.0f;
+        
+        float panL, panR;
+        panningEqualPower(params.tapPan[tap], panL, panR);
+        targetGainL[tap] = level * panL;
+        targetGainR[tap] = level * panR;
+    }
+}
+
+template<typename SampleType>
+void MultiTap<SampleType>::smoothen() noexcept
+{
+    for (size_t tap = 0; tap < maxTaps; ++tap) {
+        startDelay[tap] = delayInSamples[tap];
+        startGainL[tap] = gainL[tap];
+        startGainR[tap] = gainR[tap];
+        
+        delayInSamples[tap] += (targetDelay[tap] - delayInSamples[tap]) * delayCoeff;
+        gainL[tap] += (targetGainL[tap] - gainL[tap]) * gainCoeff;
+        gainR[tap] += (targetGainR[tap] - gainR[tap]) * gainCoeff;
+        
+        // Once a tap that is turned off has faded out, stop reading it.
+        if (gainL[tap] + gainR[tap] <= 0.00001f && targetGainL[tap] + targetGainR[tap] == 0.0f) {
+            gainL[tap] = 0.0f;
+            gainR[tap] = 0.0f;
+        }
+    }
+}
+
+template<typename SampleType>
+float MultiTap<SampleType>::getLongestDelayInSamples() const noexcept
+{
+    float longest = 0.0f;
+    for (size_t tap = 0; tap < maxTaps; ++tap) {
+        if (startGainL[tap] + startGainR[tap] + gainL[tap] + gainR[tap]
+            + targetGainL[tap] + targetGainR[tap] > 0.0f) {
+            longest = std::max({ longest, startDelay[tap], delayInSamples[tap], targetDelay[tap] });
+        }
+    }
+    return longest;
+}
+
+template class MultiTap<float>;
+template class MultiTap<double>;
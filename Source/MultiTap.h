@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    MultiTap.h
+    Created: 17 Oct 2026 2:26:50pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Parameters.h"
+#include "Tempo.h"
+#include "DelayLine.h"
+
+// Extra taps that read from the main delay line. Each tap has its own delay
+// time, level and pan. The taps only go to the output, they are not fed back
+// into the delay line.
+//
+// With a stereo delay line the taps are summed to mono and panned. With more
+// channels, every channel gets the taps of its own delay line and the pan is
+// ignored.
+//
+// The tap times and gains are float, the samples are SampleType, like the
+// delay line that the taps read from.
+template<typename SampleType>
+class MultiTap
+{
+public:
+    void prepareToPlay(double sampleRate) noexcept;
+    void reset() noexcept;
+    
+    // Call once per host block, after the parameters and tempo are updated.
+    void update(const Parameters& params, const Tempo& tempo) noexcept;
+    
+    // Moves the tap times and levels on by one sub-block of maxBlockSize
+    // samples. The smoothing is tied to that grid rather than to the calls
+    // to process(), so it glides at the same speed for any host block size.
+    // Within a sub-block, process() ramps linearly to the new values.
+    void smoothen() noexcept;
+    
+    // Adds the taps for the next block of the delay line to the output, which
+    // holds interleaved frames with the same number of channels as the delay
+    // line. Must be called before that block is written into the delay line.
+    // The block starts at gridPhase samples into the current sub-block.
+    template<typename Interpolator>
+    void process(const DelayLine<SampleType>& delayLine, SampleType* output, int numSamples,
+                 int gridPhase, Interpolator& interpolator) noexcept;
+    
+    // How far back the taps that are playing or about to play read, in samples.
+    float getLongestDelayInSamples() const noexcept;
+    
+private:
+    static constexpr int maxTaps = Parameters::maxTaps;
+    
+    double sampleRate = 44100.0;
+    float delayCoeff = 0.0f;
+    float gainCoeff = 0.0f;
+    
+    std::array<float, maxTaps> targetDelay {};
+    std::array<float, maxTaps> targetGainL {};
+    std::array<float, maxTaps> targetGainR {};
+    
+    std::array<float, maxTaps> delayInSamples {};
+    std::array<float, maxTaps> gainL {};
+    std::array<float, maxTaps> gainR {};
+    
+    // the values at the start of the current sub-block, where the ramps begin
+    std::array<float, maxTaps> startDelay {};
+    std::array<float, maxTaps> startGainL {};
+    std::array<float, maxTaps> startGainR {};
+    
+    // the delay of every tap for every sample of a block
+    std::array<float, DelayLine<SampleType>::maxBlockSize * maxTaps> tapDelays {};
+    
+    // interleaved frames for every tap of every sample of a block
+    std::array<SampleType, DelayLine<SampleType>::maxBlockSize * maxTaps
+                           * DelayLine<SampleType>::maxChannels> tapFrames {};
+};
+
+template<typename SampleType>
+template<typename Interpolator>
+void MultiTap<SampleType>::process(const DelayLine<SampleType>& delayLine, SampleType* output,
+                                   int numSamples, int gridPhase, Interpolator& interpolator) noexcept
+{
+    // The allpass interpolator keeps state per channel, which the taps would
+    // share. Use Hermite for the taps instead.
+    if constexpr (std::is_same_v<Interpolator, ThiranInterpolation<SampleType>>) {
+        HermiteInterpolation<SampleType> hermite;
+        process(delayLine, output, numSamples, gridPhase, hermite);
+    } else {
+        constexpr int maxBlockSize = DelayLine<SampleType>::maxBlockSize;
+        const int numChannels = delayLine.getNumChannels();
+        
+        size_t activeTaps[maxTaps];
+        int numActiveTaps = 0;
+        
+        // Taps that are silent for the whole sub-block are skipped.
+        for (size_t tap = 0; tap < maxTaps; ++tap) {
+            if (startGainL[tap] + startGainR[tap] + gainL[tap] + gainR[tap] > 0.0f) {
+                activeTaps[numActiveTaps] = tap;
+                numActiveTaps += 1;
+            }
+        }
+        
+        if (numActiveTaps == 0) { return; }
+        
+        // The delays ramp linearly from the start of the sub-block to its
+        // end, where they reach the values of the last smoothen(), the same
+        // way the main delay time is ramped.
+        float* delays = tapDelays.data();
+        for (int t = 0; t < numActiveTaps; ++t) {
+            size_t tap = activeTaps[t];
+            float step = (delayInSamples[tap] - startDelay[tap]) / float(maxBlockSize);
+            for (int i = 0; i < numSamples; ++i) {
+                delays[i * numActiveTaps + t] = startDelay[tap] + step * float(gridPhase + i + 1);
+            }
+        }
+        
+        // Read all the taps for the whole block in a single pass.
+        SampleType* taps = tapFrames.data();
+        delayLine.readTapsBlock(delays, numActiveTaps, taps, numSamples, interpolator);
+        
+        // The gains ramp like the delays. Each tap starts one step into
+        // the block and adds a step for every sample.
+        SampleType tapGainL[maxTaps], tapGainR[maxTaps];
+        SampleType tapStepL[maxTaps], tapStepR[maxTaps];
+        for (int t = 0; t < numActiveTaps; ++t) {
+            size_t tap = activeTaps[t];
+            float stepL = (gainL[tap] - startGainL[tap]) / float(maxBlockSize);
+            float stepR = (gainR[tap] - startGainR[tap]) / float(maxBlockSize);
+            tapGainL[t] = SampleType(startGainL[tap] + stepL * float(gridPhase));
+            tapGainR[t] = SampleType(startGainR[tap] + stepR * float(gridPhase));
+            tapStepL[t] = SampleType(stepL);
+            tapStepR[t] = SampleType(stepR);
+        }
+        
+        if (numChannels == 2) {
+            for (int i = 0; i < numSamples; ++i) {
+                const SampleType* frames = taps + i * numActiveTaps * 2;
+                SampleType outL = 0;
+                SampleType outR = 0;
+                
+                for (int tap = 0; tap < numActiveTaps; ++tap) {
+                    tapGainL[tap] += tapStepL[tap];
+                    tapGainR[tap] += tapStepR[tap];
+                    
+                    SampleType mono = (frames[2*tap] + frames[2*tap + 1]) * SampleType(0.5);
+                    outL += mono * tapGainL[tap];
+                    outR += mono * tapGainR[tap];
+                }
+                
+                output[2*i] += outL;
+                output[2*i + 1] += outR;
+            }
+        } else {
+            // The pan gains are equal power, so this is the level of the tap.
+            // It ramps from its value at the start of the sub-block to the end.
+            SampleType levels[maxTaps];
+            SampleType levelSteps[maxTaps];
+            for (int t = 0; t < numActiveTaps; ++t) {
+                size_t tap = activeTaps[t];
+                float start = std::sqrt(startGainL[tap] * startGainL[tap] + startGainR[tap] * startGainR[tap]);
+                float end = std::sqrt(gainL[tap] * gainL[tap] + gainR[tap] * gainR[tap]);
+                float step = (end - start) / float(maxBlockSize);
+                levels[t] = SampleType(start + step * float(gridPhase));
+                levelSteps[t] = SampleType(step);
+            }
+            
+            // The inner loop runs across the channels of a frame.
+            for (int i = 0; i < numSamples; ++i) {
+                const SampleType* frames = taps + i * numActiveTaps * numChannels;
+                SampleType* destination = output + i * numChannels;
+                
+                for (int tap = 0; tap < numActiveTaps; ++tap) {
+                    levels[tap] += levelSteps[tap];
+                    
+                    const SampleType* frame = frames + tap * numChannels;
+                    for (int channel = 0; channel < numChannels; ++channel) {
+                        destination[channel] += frame[channel] * levels[tap];
+                    }
+                }
+            }
+        }
+    }
+}
@@ -10,6 +10,7 @@
 
 #include "Parameters.h"
 #include "DSP.h"
+#include "Tempo.h"
 
 template<typename T>
 static void castParameter(juce::AudioProcessorValueTreeState& apvts,
@@ -83,12 +84,24 @@ Parameters::Parameters(juce::AudioProcessorValueTreeState& apvts)
     castParameter(apvts, tempoSyncParamID, tempoSyncParam);
     castParameter(apvts, delayNoteParamID, delayNoteParam);
     castParameter(apvts, bypassParamID, bypassParam);
+    castParameter(apvts, qualityParamID, qualityParam);
+    castParameter(apvts, multiTapParamID, multiTapParam);
+    castParameter(apvts, saturationParamID, saturationParam);
+    castParameter(apvts, driveParamID, driveParam);
+    castParameter(apvts, memoryParamID, memoryParam);
+    
+    for (int tap = 0; tap < maxTaps; ++tap) {
+        castParameter(apvts, tapParamID(tap, "Time"), tapTimeParams[size_t(tap)]);
+        castParameter(apvts, tapParamID(tap, "Note"), tapNoteParams[size_t(tap)]);
+        castParameter(apvts, tapParamID(tap, "Level"), tapLevelParams[size_t(tap)]);
+        castParameter(apvts, tapParamID(tap, "Pan"), tapPanParams[size_t(tap)]);
+    }
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout Parameters::createParameterLayout()
 {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
-
+    
     layout.add(std::make_unique<juce::AudioParameterFloat>(
         gainParamID,
         "Output Gain",
@@ -141,7 +154,7 @@ juce::AudioProcessorValueTreeState::ParameterLayout Parameters::createParameterL
             .withStringFromValueFunction(stringFromHz)
             .withValueFromStringFunction(hzFromString)
     ));
-
+    
     layout.add(std::make_unique<juce::AudioParameterFloat>(
         highCutParamID,
         "High Cut",
@@ -178,6 +191,78 @@ juce::AudioProcessorValueTreeState::ParameterLayout Parameters::createParameterL
         9
     ));
     
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        qualityParamID,
+        "Quality",
+        juce::StringArray { "Integer", "Linear", "Hermite", "Lagrange", "Allpass", "Sinc" },
+        int(InterpolationQuality::hermite)
+    ));
+    
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        multiTapParamID, "Multi-Tap", false
+    ));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        saturationParamID,
+        "Saturation",
+        juce::StringArray { "Off", "2x", "4x" },
+        int(SaturationMode::off)
+    ));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        driveParamID,
+        "Drive",
+        juce::NormalisableRange<float> { 0.0f, 24.0f, 0.1f },
+        6.0f,
+        juce::AudioParameterFloatAttributes().withStringFromValueFunction(stringFromDecibels)
+    ));
+    
+    // Half floats halve the memory of the delay line. Not automatable,
+    // since it only changes when the plug-in is prepared.
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        memoryParamID,
+        "Delay Memory",
+        juce::StringArray { "Full", "Compact" },
+        int(DelayMemory::full),
+        juce::AudioParameterChoiceAttributes().withAutomatable(false)
+    ));
+    
+    for (int tap = 0; tap < maxTaps; ++tap) {
+        juce::String name = "Tap " + juce::String(tap + 1) + " ";
+        
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            tapParamID(tap, "Time"),
+            name + "Time",
+            juce::NormalisableRange<float> { minDelayTime, maxDelayTime, 0.001f, 0.25f },
+            100.0f * float(tap + 1),
+            juce::AudioParameterFloatAttributes().withStringFromValueFunction(stringFromMilliseconds)
+                                                 .withValueFromStringFunction(millisecondsFromString)
+        ));
+        
+        layout.add(std::make_unique<juce::AudioParameterChoice>(
+            tapParamID(tap, "Note"),
+            name + "Note",
+            noteLengths,
+            9
+        ));
+        
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            tapParamID(tap, "Level"),
+            name + "Level",
+            juce::NormalisableRange<float>(0.0f, 100.0f, 1.0f),
+            0.0f,
+            juce::AudioParameterFloatAttributes().withStringFromValueFunction(stringFromPercent)
+        ));
+        
+        layout.add(std::make_unique<juce::AudioParameterFloat>(
+            tapParamID(tap, "Pan"),
+            name + "Pan",
+            juce::NormalisableRange<float>(-100.0f, 100.0f, 1.0f),
+            0.0f,
+            juce::AudioParameterFloatAttributes().withStringFromValueFunction(stringFromPercent)
+        ));
+    }
+    
     return layout;
 }
 
@@ -193,31 +278,40 @@ void Parameters::prepareToPlay(double sampleRate) noexcept
     stereoSmoother.reset(sampleRate, duration);
     lowCutSmoother.reset(sampleRate, duration);
     highCutSmoother.reset(sampleRate, duration);
+    driveSmoother.reset(sampleRate, duration);
+    bypassSmoother.reset(sampleRate, duration);
 }
 
 void Parameters::reset() noexcept
 {
-    gain = 0.0f;
     gainSmoother.setCurrentAndTargetValue(juce::Decibels::decibelsToGain(gainParam->get()));
     
-    delayTime = 0.0f;
+    currentDelayTime = 0.0f;
     
-    mix = 1.0f;
     mixSmoother.setCurrentAndTargetValue(mixParam->get() * 0.01f);
-    
-    feedback = 0.0f;
     feedbackSmoother.setCurrentAndTargetValue(feedbackParam->get() * 0.01f);
     
-    panL = 0.0f;
-    panR = 1.0f;
-    
     stereoSmoother.setCurrentAndTargetValue(stereoParam->get() * 0.01f);
+    panningEqualPower(stereoSmoother.getCurrentValue(), currentPanL, currentPanR);
     
-    lowCut = 20.0f;
     lowCutSmoother.setCurrentAndTargetValue(lowCutParam->get());
-    
-    highCut = 20000.0f;
     highCutSmoother.setCurrentAndTargetValue(highCutParam->get());
+    driveSmoother.setCurrentAndTargetValue(juce::Decibels::decibelsToGain(driveParam->get()));
+    
+    memory = DelayMemory(memoryParam->getIndex());
+    
+    bypassed = bypassParam->get();
+    bypassSmoother.setCurrentAndTargetValue(bypassed ? 1.0f : 0.0f);
+    
+    gainIsConstant = false;
+    delayTimeIsConstant = false;
+    mixIsConstant = false;
+    feedbackIsConstant = false;
+    panIsConstant = false;
+    lowCutIsConstant = false;
+    highCutIsConstant = false;
+    driveIsConstant = false;
+    bypassIsConstant = false;
 }
 
 void Parameters::update() noexcept
@@ -225,8 +319,8 @@ void Parameters::update() noexcept
     gainSmoother.setTargetValue(juce::Decibels::decibelsToGain(gainParam->get()));
     
     targetDelayTime = delayTimeParam->get();
-    if (delayTime == 0.0f) {
-        delayTime = targetDelayTime;
+    if (currentDelayTime == 0.0f) {
+        currentDelayTime = targetDelayTime;
     }
     
     mixSmoother.setTargetValue(mixParam->get() * 0.01f);
@@ -234,22 +328,124 @@ void Parameters::update() noexcept
     stereoSmoother.setTargetValue(stereoParam->get() * 0.01f);
     lowCutSmoother.setTargetValue(lowCutParam->get());
     highCutSmoother.setTargetValue(highCutParam->get());
+    driveSmoother.setTargetValue(juce::Decibels::decibelsToGain(driveParam->get()));
     delayNote = delayNoteParam->getIndex();
     tempoSync = tempoSyncParam->get();
     bypassed = bypassParam->get();
+    bypassSmoother.setTargetValue(bypassed ? 1.0f : 0.0f);
+    quality = InterpolationQuality(qualityParam->getIndex());
+    saturation = SaturationMode(saturationParam->getIndex());
+    
+    multiTap = multiTapParam->get();
+    for (size_t tap = 0; tap < maxTaps; ++tap) {
+        tapTime[tap] = tapTimeParams[tap]->get();
+        tapNote[tap] = tapNoteParams[tap]->getIndex();
+        tapLevel[tap] = tapLevelParams[tap]->get() * 0.01f;
+        tapPan[tap] = tapPanParams[tap]->get() * 0.01f;
+    }
+}
+
+// Fills a block with a linear ramp from the current value of the smoother.
+// While the smoother is idle the block already holds its target value, so
+// it is only filled once.
+static void fillBlock(juce::LinearSmoothedValue<float>& smoother, float* block,
+                      bool& isConstant, int numSamples) noexcept
+{
+    if (smoother.isSmoothing()) {
+        float start = smoother.getCurrentValue();
+        float end = smoother.skip(numSamples);
+        float step = (end - start) / float(numSamples);
+        
+        for (int i = 0; i < numSamples; ++i) {
+            block[i] = start + step * float(i + 1);
+        }
+        isConstant = false;
+    } else if (!isConstant) {
+        juce::FloatVectorOperations::fill(block, smoother.getTargetValue(), Parameters::maxBlockSize);
+        isConstant = true;
+    }
 }
 
-void Parameters::smoothen() noexcept
+void Parameters::smoothen(int numSamples) noexcept
 {
-    gain = gainSmoother.getNextValue();
+    jassert(numSamples <= maxBlockSize);
     
-    delayTime += (targetDelayTime - delayTime) * coeff;
+    fillBlock(gainSmoother, gain, gainIsConstant, numSamples);
+    fillBlock(mixSmoother, mix, mixIsConstant, numSamples);
+    fillBlock(feedbackSmoother, feedback, feedbackIsConstant, numSamples);
+    fillBlock(lowCutSmoother, lowCut, lowCutIsConstant, numSamples);
+    fillBlock(highCutSmoother, highCut, highCutIsConstant, numSamples);
+    fillBlock(driveSmoother, drive, driveIsConstant, numSamples);
+    fillBlock(bypassSmoother, bypass, bypassIsConstant, numSamples);
     
-    mix = mixSmoother.getNextValue();
-    feedback = feedbackSmoother.getNextValue();
+    // The one-pole filter is recursive and has to run sample by sample, but
+    // only until it has settled on the target.
+    if (std::abs(targetDelayTime - currentDelayTime) > 0.0001f) {
+        for (int i = 0; i < numSamples; ++i) {
+            currentDelayTime += (targetDelayTime - currentDelayTime) * coeff;
+            delayTime[i] = currentDelayTime;
+        }
+        delayTimeIsConstant = false;
+    } else if (!delayTimeIsConstant || currentDelayTime != targetDelayTime) {
+        currentDelayTime = targetDelayTime;
+        juce::FloatVectorOperations::fill(delayTime, currentDelayTime, maxBlockSize);
+        delayTimeIsConstant = true;
+    }
     
-    panningEqualPower(stereoSmoother.getNextValue(), panL, panR);
+    // Equal power panning is only calculated at the end of the block. Over
+    // such a short block, a linear ramp towards it is indistinguishable.
+    if (stereoSmoother.isSmoothing()) {
+        float startL = currentPanL;
+        float startR = currentPanR;
+        panningEqualPower(stereoSmoother.skip(numSamples), currentPanL, currentPanR);
+        
+        float stepL = (currentPanL - startL) / float(numSamples);
+        float stepR = (currentPanR - startR) / float(numSamples);
+        for (int i = 0; i < numSamples; ++i) {
+            panL[i] = startL + stepL * float(i + 1);
+            panR[i] = startR + stepR * float(i + 1);
+        }
+        panIsConstant = false;
+    } else if (!panIsConstant) {
+        panningEqualPower(stereoSmoother.getTargetValue(), currentPanL, currentPanR);
+        juce::FloatVectorOperations::fill(panL, currentPanL, maxBlockSize);
+        juce::FloatVectorOperations::fill(panR, currentPanR, maxBlockSize);
+        panIsConstant = true;
+    }
+}
+
+double Parameters::getTailLengthSeconds(double bpm, float threshold) const noexcept
+{
+    auto delayTimeFor = [&](float time, int note) {
+        double ms = tempoSyncParam->get() ? Tempo::getMillisecondsForNoteLength(note, bpm) : double(time);
+        return std::clamp(ms, double(minDelayTime), double(maxDelayTime)) / 1000.0;
+    };
+    
+    // Every echo is quieter than the one before by the feedback gain. The
+    // saturation has unity gain for quiet signals and the filters only take
+    // away, so this is the longest that the echoes can last.
+    double feedback = std::abs(double(feedbackParam->get()) * 0.01);
+    if (feedback >= 1.0) {
+        return std::numeric_limits<double>::infinity();
+    }
     
-    lowCut = lowCutSmoother.getNextValue();
-    highCut = highCutSmoother.getNextValue();
+    // The taps read the same delay line as the main delay, which holds the
+    // echoes fed back, so every tap repeats as often as the main delay does.
+    // The tail starts from whichever of them is heard last.
+    double delay = delayTimeFor(delayTimeParam->get(), delayNoteParam->getIndex());
+    double tail = delay;
+    if (multiTapParam->get()) {
+        for (size_t tap = 0; tap < maxTaps; ++tap) {
+            if (tapLevelParams[tap]->get() > 0.0f) {
+                tail = std::max(tail, delayTimeFor(tapTimeParams[tap]->get(), tapNoteParams[tap]->getIndex()));
+            }
+        }
+    }
+    
+    // Rounding the number of repeats up lets the tail run until the last
+    // audible echo has gone by, not stop where it starts.
+    if (feedback > 0.0) {
+        tail += delay * std::ceil(std::log(double(threshold)) / std::log(feedback));
+    }
+    return tail;
 }
@@ -22,6 +22,43 @@ const juce::ParameterID highCutParamID { "highCut", 1 };
 const juce::ParameterID tempoSyncParamID { "tempoSync", 1 };
 const juce::ParameterID delayNoteParamID { "delayNote", 1 };
 const juce::ParameterID bypassParamID { "bypass", 1 };
+const juce::ParameterID qualityParamID { "quality", 1 };
+const juce::ParameterID multiTapParamID { "multiTap", 1 };
+const juce::ParameterID saturationParamID { "saturation", 1 };
+const juce::ParameterID driveParamID { "drive", 1 };
+const juce::ParameterID memoryParamID { "memory", 1 };
+
+// The taps of the multi-tap mode use IDs such as "tap1Time" and "tap16Pan".
+inline juce::ParameterID tapParamID(int tap, const juce::String& name)
+{
+    return { "tap" + juce::String(tap + 1) + name, 1 };
+}
+
+// The order must match the choices of the quality parameter.
+enum class InterpolationQuality
+{
+    integer,
+    linear,
+    hermite,
+    lagrange,
+    allpass,
+    sinc,
+};
+
+// The order must match the choices of the saturation parameter.
+enum class SaturationMode
+{
+    off,
+    oversample2x,
+    oversample4x,
+};
+
+// The order must match the choices of the memory parameter.
+enum class DelayMemory
+{
+    full,
+    compact,
+};
 
 class Parameters
 {
@@ -33,19 +70,58 @@ public:
     void prepareToPlay(double sampleRate) noexcept;
     void reset() noexcept;
     void update() noexcept;
-    void smoothen() noexcept;
-
-    float gain = 0.0f;
-    float delayTime = 0.0f;
-    float mix = 1.0f;
-    float feedback = 0.0f;
-    float panL = 0.0f;
-    float panR = 1.0f;
-    float lowCut = 20.0f;
-    float highCut = 20000.0f;
+    
+    // Fills the blocks below with the next numSamples smoothed values.
+    void smoothen(int numSamples) noexcept;
+    
+    // How long the echoes of a full scale input take to fall below the
+    // threshold, in seconds, or infinity if they never do. This reads the
+    // parameters themselves, so it can be called from any thread. The
+    // synced delay times use the given tempo.
+    double getTailLengthSeconds(double bpm, float threshold) const noexcept;
+    
+    static constexpr int maxBlockSize = 32;
+    
+    float gain[maxBlockSize] = {};
+    float delayTime[maxBlockSize] = {};
+    float mix[maxBlockSize] = {};
+    float feedback[maxBlockSize] = {};
+    float panL[maxBlockSize] = {};
+    float panR[maxBlockSize] = {};
+    float lowCut[maxBlockSize] = {};
+    float highCut[maxBlockSize] = {};
+    float drive[maxBlockSize] = {};   // linear gain
+    float bypass[maxBlockSize] = {};  // 0 = processed, 1 = dry
+    
     int delayNote = 0;
     bool tempoSync = false;
     bool bypassed = false;
+    InterpolationQuality quality = InterpolationQuality::hermite;
+    SaturationMode saturation = SaturationMode::off;
+    
+    // Only read by reset(), since changing it reallocates the delay line.
+    // It takes effect the next time the host prepares the plug-in.
+    DelayMemory memory = DelayMemory::full;
+    
+    // True once the fade into bypass is over and the output is only the
+    // dry signal. The fade itself is in the bypass block above.
+    bool isFullyBypassed() const noexcept
+    {
+        return bypassed && !bypassSmoother.isSmoothing();
+    }
+    
+    bool isBypassFading() const noexcept
+    {
+        return bypassSmoother.isSmoothing();
+    }
+    
+    static constexpr int maxTaps = 16;
+    
+    bool multiTap = false;
+    std::array<float, maxTaps> tapTime {};   // ms
+    std::array<int, maxTaps> tapNote {};
+    std::array<float, maxTaps> tapLevel {};  // linear gain
+    std::array<float, maxTaps> tapPan {};    // -1 to 1
     
     static constexpr float minDelayTime = 5.0f;
     static constexpr float maxDelayTime = 5000.0f;
@@ -59,6 +135,7 @@ private:
     juce::LinearSmoothedValue<float> gainSmoother;
     
     juce::AudioParameterFloat* delayTimeParam;
+    float currentDelayTime = 0.0f;
     float targetDelayTime = 0.0f;
     float coeff = 0.0f; // one-pole filter smoothing
     
@@ -70,6 +147,8 @@ private:
     
     juce::AudioParameterFloat* stereoParam;
     juce::LinearSmoothedValue<float> stereoSmoother;
+    float currentPanL = 0.0f;
+    float currentPanR = 1.0f;
     
     juce::AudioParameterFloat* lowCutParam;
     juce::LinearSmoothedValue<float> lowCutSmoother;
@@ -79,5 +158,33 @@ private:
     
     juce::AudioParameterChoice* delayNoteParam;
     
+    juce::AudioParameterChoice* saturationParam;
+    juce::AudioParameterFloat* driveParam;
+    juce::LinearSmoothedValue<float> driveSmoother;
+    
+    juce::AudioParameterChoice* memoryParam;
+    
+    juce::LinearSmoothedValue<float> bypassSmoother;
+    
+    // Set when a block is filled with a constant value. As long as the value
+    // does not change, there is no need to fill the block again.
+    bool gainIsConstant = false;
+    bool delayTimeIsConstant = false;
+    bool mixIsConstant = false;
+    bool feedbackIsConstant = false;
+    bool panIsConstant = false;
+    bool lowCutIsConstant = false;
+    bool highCutIsConstant = false;
+    bool driveIsConstant = false;
+    bool bypassIsConstant = false;
+    
+    juce::AudioParameterChoice* qualityParam;
+    
+    juce::AudioParameterBool* multiTapParam;
+    std::array<juce::AudioParameterFloat*, maxTaps> tapTimeParams;
+    std::array<juce::AudioParameterChoice*, maxTaps> tapNoteParams;
+    std::array<juce::AudioParameterFloat*, maxTaps> tapLevelParams;
+    std::array<juce::AudioParameterFloat*, maxTaps> tapPanParams;
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Parameters)
 };
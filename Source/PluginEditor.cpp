@@ -11,7 +11,7 @@
 
 //==============================================================================
 
-DelayDSPAudioProcessorEditor::DelayDSPAudioProcessorEditor (DelayDSPAudioProcessor& p) : AudioProcessorEditor (&p), audioProcessor (p), meter(p.levelL, p.levelR)
+DelayDSPAudioProcessorEditor::DelayDSPAudioProcessorEditor (DelayDSPAudioProcessor& p) : AudioProcessorEditor (&p), audioProcessor (p), meter(p.levels), loadMeter(p.load)
 {
     delayGroup.setText("Delay");
     delayGroup.setTextLabelPosition(juce::Justification::horizontallyCentred);
@@ -49,12 +49,18 @@ DelayDSPAudioProcessorEditor::DelayDSPAudioProcessorEditor (DelayDSPAudioProcess
                 bypassIcon, 1.0f, juce::Colours::grey, 0.0f);
     addAndMakeVisible(bypassButton);
     
+    addAndMakeVisible(loadMeter);
+    
     setLookAndFeel (&mainLF);
+    
+    // the background covers the whole editor, so nothing behind it needs painting
+    setOpaque(true);
         
     setSize(500, 330);
     
     updateDelayKnobs(audioProcessor.params.tempoSyncParam->get());
     audioProcessor.params.tempoSyncParam->addListener(this);
+    startTimerHz(10);
 
     
 }
@@ -67,6 +73,24 @@ DelayDSPAudioProcessorEditor::~DelayDSPAudioProcessorEditor()
 
 //==============================================================================
 void DelayDSPAudioProcessorEditor::paint (juce::Graphics& g)
+{
+    float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (background.isNull() || scale != backgroundScale) {
+        background = juce::Image(juce::Image::RGB,
+                                 std::max(1, juce::roundToInt(float(getWidth()) * scale)),
+                                 std::max(1, juce::roundToInt(float(getHeight()) * scale)), false);
+        backgroundScale = scale;
+        
+        juce::Graphics imageGraphics(background);
+        imageGraphics.addTransform(juce::AffineTransform::scale(float(background.getWidth()) / float(getWidth()),
+                                                                float(background.getHeight()) / float(getHeight())));
+        drawBackground(imageGraphics);
+    }
+    
+    g.drawImage(background, getLocalBounds().toFloat());
+}
+
+void DelayDSPAudioProcessorEditor::drawBackground(juce::Graphics& g)
 {
     auto noise = juce::ImageCache::getFromMemory( BinaryData::Noise_png, BinaryData::Noise_pngSize);
     auto fillType = juce::FillType(noise, juce::AffineTransform::scale(0.5f)); g.setFillType(fillType);
@@ -81,6 +105,8 @@ void DelayDSPAudioProcessorEditor::paint (juce::Graphics& g)
 
 void DelayDSPAudioProcessorEditor::resized()
 {
+    background = {};
+    
     auto bounds = getLocalBounds();
     int y = 50;
     int height = bounds.getHeight() - 60; // Position the groups
@@ -106,16 +132,23 @@ void DelayDSPAudioProcessorEditor::resized()
         meter.setBounds(outputGroup.getWidth() - 45, 30, 30, gainKnob.getBottom() - 30);
         
         bypassButton.setTopLeftPosition(bounds.getRight() - bypassButton.getWidth() - 10, 10);
+        loadMeter.setBounds(10, 5, 120, 30);
 }
 
 void DelayDSPAudioProcessorEditor::parameterValueChanged(int, float value)
 {
+    // On the audio thread, posting a message would allocate and lock, so the
+    // change is only flagged for timerCallback().
     if (juce::MessageManager::getInstance()->isThisTheMessageThread()) { updateDelayKnobs(value != 0.0f);
     } else {
-        juce::MessageManager::callAsync([this, value]
-        {
-            updateDelayKnobs(value != 0.0f);
-        });
+        tempoSyncChanged.store(true);
+    }
+}
+
+void DelayDSPAudioProcessorEditor::timerCallback()
+{
+    if (tempoSyncChanged.exchange(false)) {
+        updateDelayKnobs(audioProcessor.params.tempoSyncParam->get());
     }
 }
 
@@ -14,12 +14,14 @@
 #include "RotaryKnob.h"
 #include "LookAndFeel.h"
 #include "LevelMeter.h"
+#include "LoadMeter.h"
 
 //==============================================================================
 /**
 */
 class DelayDSPAudioProcessorEditor  : public juce::AudioProcessorEditor,
-                                      private juce::AudioProcessorParameter::Listener
+                                      private juce::AudioProcessorParameter::Listener,
+                                      private juce::Timer
 {
 public:
     DelayDSPAudioProcessorEditor (DelayDSPAudioProcessor&);
@@ -32,7 +34,9 @@ public:
 private:
     void parameterValueChanged(int, float) override;
     void parameterGestureChanged(int, bool) override { }
+    void timerCallback() override;
     void updateDelayKnobs(bool tempoSyncActive);
+    void drawBackground(juce::Graphics& g);
     
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
@@ -62,9 +66,19 @@ private:
     juce::GroupComponent delayGroup, feedbackGroup, outputGroup;
     
     LevelMeter meter;
+    LoadMeter loadMeter;
     
     MainLookAndFeel mainLF;
     
+    // The noise texture, header and logo, composited once per size and
+    // scale factor. Repaints of the knobs and meters only copy from it.
+    juce::Image background;
+    float backgroundScale = 0.0f;
+    
+    // Set when the tempo sync parameter changes on another thread, such as
+    // the audio thread during automation. The timer picks it up.
+    std::atomic<bool> tempoSyncChanged { false };
+    
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayDSPAudioProcessorEditor)
 };
@@ -8,7 +8,6 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
-#include "ProtectYourEars.h"
 
 //==============================================================================
 DelayDSPAudioProcessor::DelayDSPAudioProcessor() :
@@ -19,8 +18,6 @@ DelayDSPAudioProcessor::DelayDSPAudioProcessor() :
     ),
     params(apvts)
 {
-    lowCutFilter.setType(juce::dsp::StateVariableTPTFilterType::highpass);
-    highCutFilter.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
 }
 
 DelayDSPAudioProcessor::~DelayDSPAudioProcessor()
@@ -62,7 +59,7 @@ bool DelayDSPAudioProcessor::isMidiEffect() const
 
 double DelayDSPAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return params.getTailLengthSeconds(hostTempo.load(), silenceThreshold);
 }
 
 int DelayDSPAudioProcessor::getNumPrograms()
@@ -90,41 +87,90 @@ void DelayDSPAudioProcessor::changeProgramName (int, const juce::String&)
 }
 
 //==============================================================================
-void DelayDSPAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+void DelayDSPAudioProcessor::prepareToPlay (double sampleRate, [[maybe_unused]] int samplesPerBlock)
 {
     params.prepareToPlay(sampleRate);
     params.reset();
     
-    tempo.reset();
+    tempo.prepare(sampleRate);
     
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = juce::uint32(samplesPerBlock);
-    spec.numChannels = 2;
-        
-    double numSamples = Parameters::maxDelayTime / 1000.0 * sampleRate;
-    int maxDelayInSamples = int(std::ceil(numSamples));
+    // Mono and stereo share a stereo delay line. Larger layouts get one
+    // channel per bus channel.
+    int numChannels = std::max(getMainBusNumOutputChannels(), 2);
     
-    delayLineL.setMaximumDelayInSamples(maxDelayInSamples);
-    delayLineR.setMaximumDelayInSamples(maxDelayInSamples);
-    delayLineL.reset();
-    delayLineR.reset();
+    auto storage = params.memory == DelayMemory::compact ? DelayLineStorage::half
+                                                         : DelayLineStorage::full;
     
-    feedbackL = 0.0f;
-    feedbackR = 0.0f;
+    int maxDelayInSamples = int(std::ceil(Parameters::maxDelayTime / 1000.0 * sampleRate));
+    bool lockMemory = DELAYDSP_LOCK_DELAY_MEMORY != 0;
     
-    lowCutFilter.prepare(spec);
-    lowCutFilter.reset();
+    // The host sets the precision before preparing, and may change it
+    // only by preparing again. The arena is reserved for the engine that
+    // is about to run, which takes the delay line from it.
+    if (isUsingDoublePrecision()) {
+        delayMemory.reserve(DelayLine<double>::getMemorySize(maxDelayInSamples, numChannels, storage),
+                            lockMemory);
+        doubleEngine.prepare(sampleRate, maxDelayInSamples, numChannels, storage,
+                             params.saturation, delayMemory);
+    } else {
+        delayMemory.reserve(DelayLine<float>::getMemorySize(maxDelayInSamples, numChannels, storage),
+                            lockMemory);
+        floatEngine.prepare(sampleRate, maxDelayInSamples, numChannels, storage,
+                            params.saturation, delayMemory);
+    }
     
-    highCutFilter.prepare(spec);
-    highCutFilter.reset();
+    // The oversampling only delays the feedback, and that is compensated
+    // inside the loop. The plug-in itself has no latency to report.
+    setLatencySamples(0);
+    
+    levels.prepare(sampleRate);
+    samplePosition = 0;
+    wasBypassed = false;
+    silentSamples = 0;
+    isAsleep = false;
+    
+    load.prepare(sampleRate);
+
+}
+
+template<typename SampleType>
+void DelayDSPAudioProcessor::Engine<SampleType>::prepare(double sampleRate, int maxDelayInSamples,
+                                                         int numChannels, DelayLineStorage storage,
+                                                         SaturationMode saturationMode,
+                                                         MemoryArena& memory)
+{
+    delayLine.setMaximumDelayInSamples(memory, maxDelayInSamples, numChannels, storage);
+    delayLine.reset();
+    
+    multiTap.prepareToPlay(sampleRate);
+    multiTap.reset();
     
-    lastLowCut = -1.0f;
-    lastHighCut = -1.0f;
+    lowCutFilter.setType(StateVariableFilter<SampleType>::Type::highpass);
+    highCutFilter.setType(StateVariableFilter<SampleType>::Type::lowpass);
+    lowCutFilter.setControlRate(filterControlRate);
+    highCutFilter.setControlRate(filterControlRate);
+    lowCutFilter.prepare(sampleRate, numChannels);
+    highCutFilter.prepare(sampleRate, numChannels);
     
-    levelL.reset();
-    levelR.reset();
+    saturation.prepare(sampleRate, numChannels);
+    currentSaturationMode = saturationMode;
+    
+    clear(false);
+}
 
+template<typename SampleType>
+void DelayDSPAudioProcessor::Engine<SampleType>::clear(bool clearDelayLine) noexcept
+{
+    if (clearDelayLine) {
+        delayLine.clear();
+    }
+    thiranInterpolation.reset();
+    
+    feedback.fill(0);
+    lowCutFilter.reset();
+    highCutFilter.reset();
+    saturation.reset();
+    wetHistory.fill(0);
 }
 
 void DelayDSPAudioProcessor::releaseResources()
@@ -144,106 +190,504 @@ bool DelayDSPAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     if (mainIn == mono && mainOut == stereo) { return true; }
     if (mainIn == stereo && mainOut == stereo) { return true; }
     
+    // Quad, surround, ambisonics and so on, as long as the input and output
+    // match and every channel fits in the delay line.
+    if (mainIn == mainOut && mainOut.size() > 2 && mainOut.size() <= DelayLine<float>::maxChannels) {
+        return true;
+    }
+    
     return false;
 }
 
+template<typename SampleType>
+static bool isSilent(const juce::AudioBuffer<SampleType>& buffer, float threshold) noexcept
+{
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+        if (buffer.getMagnitude(channel, 0, buffer.getNumSamples()) > SampleType(threshold)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void DelayDSPAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, [[maybe_unused]] juce::MidiBuffer& midiMessages)
+{
+    process(buffer, floatEngine);
+}
+
+void DelayDSPAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, [[maybe_unused]] juce::MidiBuffer& midiMessages)
+{
+    process(buffer, doubleEngine);
+}
+
+template<typename SampleType>
+void DelayDSPAudioProcessor::process(juce::AudioBuffer<SampleType>& buffer, Engine<SampleType>& engine) noexcept
 {
     juce::ScopedNoDenormals noDenormals;
+    LoadMeasurement::ScopedTimer loadTimer(load, buffer.getNumSamples());
+    
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
-
+    
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
-
+    
     params.update();
     
-    tempo.update(getPlayHead());
+    // Mono to stereo: the right output channel starts out with the dry
+    // signal too, since the output is mixed in place. This comes before the
+    // bypass and the sleep, which both leave the dry signal as it is.
+    auto mainInput = getBusBuffer(buffer, true, 0);
+    auto mainOutput = getBusBuffer(buffer, false, 0);
+    if (mainOutput.getNumChannels() > 1 && mainInput.getNumChannels() == 1) {
+        juce::FloatVectorOperations::copy(mainOutput.getWritePointer(1), mainInput.getReadPointer(0),
+                                          buffer.getNumSamples());
+    }
+    
+    // Once the fade into bypass is over, the audio passes through untouched.
+    if (params.isFullyBypassed()) {
+        processBypassed(buffer, engine);
+        return;
+    }
+    
+    // The feedback loop stopped in the middle of whatever it was doing, so
+    // it starts over. While bypassed, the delay line was either kept fed or
+    // it holds audio from before the bypass, which must not come back.
+    if (wasBypassed) {
+        engine.clear(!DELAYDSP_FEED_DELAY_WHEN_BYPASSED);
+        wasBypassed = false;
+    }
     
-    float syncedTime = float(tempo.getMillisecondsForNoteLength(params.delayNote));
-    if (syncedTime > Parameters::maxDelayTime) {
-        syncedTime = Parameters::maxDelayTime;
+    // Asleep, the input is only checked for sound. See the end of this
+    // function for how the plug-in falls asleep.
+    bool isInputSilent = isSilent(mainInput, silenceThreshold);
+    if (isAsleep) {
+        if (isInputSilent) {
+            samplePosition += buffer.getNumSamples();
+            return;
+        }
+        isAsleep = false;
     }
     
+    tempo.update(getPlayHead(), buffer.getNumSamples());
+    hostTempo.store(tempo.getTempo());
+    
+    engine.multiTap.update(params, tempo);
+    
     float sampleRate = float(getSampleRate());
-
-    auto mainInput = getBusBuffer(buffer, true, 0);
+    float minDelayInSamples = Parameters::minDelayTime / 1000.0f * sampleRate;
+    float maxDelayInSamples = Parameters::maxDelayTime / 1000.0f * sampleRate;
+    
     auto mainInputChannels = mainInput.getNumChannels();
     auto isMainInputStereo = mainInputChannels > 1;
-    const float* inputDataL = mainInput.getReadPointer(0);
-    const float* inputDataR = mainInput.getReadPointer(isMainInputStereo ? 1 : 0);
+    const SampleType* inputDataL = mainInput.getReadPointer(0);
+    const SampleType* inputDataR = mainInput.getReadPointer(isMainInputStereo ? 1 : 0);
     
-    auto mainOutput = getBusBuffer(buffer, false, 0);
     auto mainOutputChannels = mainOutput.getNumChannels();
     auto isMainOutputStereo = mainOutputChannels > 1;
-    float* outputDataL = mainOutput.getWritePointer(0);
-    float* outputDataR = mainOutput.getWritePointer(isMainOutputStereo ? 1 : 0);
-
-    float maxL = 0.0f;
-    float maxR = 0.0f;
-
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
-        params.smoothen();
-        
-        float delayTime = params.tempoSync ? syncedTime : params.delayTime;
-        float delayInSamples = delayTime / 1000.0f * sampleRate;
+    SampleType* outputDataL = mainOutput.getWritePointer(0);
+    SampleType* outputDataR = mainOutput.getWritePointer(isMainOutputStereo ? 1 : 0);
+    
+    auto& delayLine = engine.delayLine;
+    auto& feedback = engine.feedback;
+    auto& saturation = engine.saturation;
+    
+    // With more than two channels, every channel is delayed on its own and
+    // the per-sample work runs across the channels of each frame.
+    int numChannels = delayLine.getNumChannels();
+    bool isMultichannel = numChannels > 2;
+    jassert(!isMultichannel || (mainInputChannels == numChannels && mainOutputChannels == numChannels));
+    
+    jassert(inputDataL == outputDataL);
+    
+    const auto& kernels = getKernels().get<SampleType>();
+    
+    // Switching the oversampling moves the read position, which is no
+    // worse than switching the interpolation quality.
+    auto saturationMode = params.saturation;
+    if (saturationMode != engine.currentSaturationMode) {
+        saturation.reset();
+        engine.wetHistory.fill(0);
+        engine.currentSaturationMode = saturationMode;
+    }
+    int latency = saturation.getLatencyInSamples(saturationMode);
+    
+    // While fading in or out of bypass, the mixed output is faded against
+    // a copy of the dry signal.
+    bool isCrossfading = params.bypassed || params.isBypassFading();
+    
+    SampleType maxL = 0;
+    SampleType maxR = 0;
+    SampleType sumSquaresL = 0;
+    SampleType sumSquaresR = 0;
+    
+    // the loudest value read from the delay line, and the longest delay
+    SampleType wetPeak = 0;
+    float longestDelay = 0.0f;
+    
+    constexpr int maxBlockSize = DelayLine<SampleType>::maxBlockSize;
+    static_assert(Parameters::maxBlockSize == maxBlockSize);
+    static_assert(FeedbackSaturation<SampleType>::maxBlockSize == maxBlockSize);
+    
+    constexpr int maxChannels = DelayLine<SampleType>::maxChannels;
+    static_assert(maxBlockSize % filterControlRate == 0);
+    
+    float delayInSamples[maxBlockSize];
+    
+    // interleaved frames
+    SampleType wet[maxBlockSize * maxChannels];
+    SampleType taps[maxBlockSize * maxChannels];
+    SampleType delayInput[maxBlockSize * maxChannels];
+    SampleType feedbackFrames[(maxBlockSize + 1) * maxChannels];
+    SampleType monoRight[maxBlockSize];
+    SampleType dry[maxBlockSize * maxChannels];
+    
+    const SampleType* inputChannels[maxChannels];
+    SampleType* outputChannels[maxChannels];
+    if (isMultichannel) {
+        for (int channel = 0; channel < numChannels; ++channel) {
+            inputChannels[channel] = mainInput.getReadPointer(channel);
+        }
+    }
+    
+    // The delay line is processed in small blocks. Every block is read from
+    // the delay line in one go, then the feedback is computed sample by
+    // sample, and finally the new block is written. This is safe because the
+    // shortest possible delay time is much longer than a block.
+    //
+    // The sub-blocks follow a grid of maxBlockSize samples that carries on
+    // from one host block to the next. The control-rate work happens at grid
+    // points only, so it costs the same per sample whatever block size the
+    // host uses. A host block that is not aligned to the grid simply gets a
+    // shorter sub-block at either end, which adds no latency.
+    for (int offset = 0, blockSize = 0; offset < buffer.getNumSamples(); offset += blockSize) {
+        int phase = int((samplePosition + offset) % maxBlockSize);
+        blockSize = std::min(buffer.getNumSamples() - offset, maxBlockSize - phase);
         
-        if (params.lowCut != lastLowCut) { 
-            lowCutFilter.setCutoffFrequency(params.lowCut);
-            lastLowCut = params.lowCut;
+        if (phase == 0) {
+            engine.multiTap.smoothen();
         }
-        if (params.highCut != lastHighCut) {
-            highCutFilter.setCutoffFrequency(params.highCut);
-            lastHighCut = params.highCut;
+        
+        params.smoothen(blockSize);
+        
+        if (params.tempoSync) {
+            // The synced delay follows the tempo ramp within the host block.
+            // It is worked out at both ends of the sub-block and filled in
+            // linearly between them.
+            float start = float(tempo.getSamplesForNoteLength(params.delayNote, offset));
+            float end = float(tempo.getSamplesForNoteLength(params.delayNote, offset + blockSize));
+            start = std::clamp(start, minDelayInSamples, maxDelayInSamples);
+            end = std::clamp(end, minDelayInSamples, maxDelayInSamples);
+            
+            float step = (end - start) / float(blockSize);
+            for (int i = 0; i < blockSize; ++i) {
+                delayInSamples[i] = start + step * float(i + 1);
+            }
+        } else {
+            juce::FloatVectorOperations::multiply(delayInSamples, params.delayTime, sampleRate / 1000.0f, blockSize);
         }
-
-        float dryL = inputDataL[sample];
-        float dryR = inputDataR[sample];
         
-        // convert stereo to mono
-        float mono = (dryL + dryR) * 0.5f;
-
-        delayLineL.write(mono*params.panL + feedbackR);
-        delayLineR.write(mono*params.panR + feedbackL);
+        // The feedback is read earlier by the latency of the saturation, so
+        // that it arrives back in the delay line on time. At low sample rates
+        // the shortest delays would then read ahead of the block that is yet
+        // to be written, so those come back a few samples late instead.
+        if (latency > 0) {
+            juce::FloatVectorOperations::add(delayInSamples, -float(latency), blockSize);
+            juce::FloatVectorOperations::max(delayInSamples, delayInSamples,
+                                             float(DelayLine<SampleType>::minBlockDelay), blockSize);
+        }
         
-        float wetL = delayLineL.read(delayInSamples);
-        float wetR = delayLineR.read(delayInSamples);
+        engine.readDelayLine(params.quality, delayInSamples, wet, taps, blockSize, phase);
         
-        feedbackL = wetL * params.feedback;
-        feedbackL = lowCutFilter.processSample(0, feedbackL);
-        feedbackL = highCutFilter.processSample(0, feedbackL);
+        // The wet signal is also what goes back into the delay line.
+        auto wetRange = juce::FloatVectorOperations::findMinAndMax(wet, blockSize * numChannels);
+        wetPeak = std::max({ wetPeak, -wetRange.getStart(), wetRange.getEnd() });
+        longestDelay = std::max(longestDelay, delayInSamples[blockSize - 1]);
         
-        feedbackR = wetR * params.feedback;
-        feedbackR = lowCutFilter.processSample(1, feedbackR);
-        feedbackR = highCutFilter.processSample(1, feedbackR);
+        // The feedback branch only depends on what was read, so it is done
+        // for the whole block first. Frame i + 1 holds the feedback of
+        // sample i, which goes into the delay line with sample i + 1.
+        std::copy(feedback.begin(), feedback.begin() + numChannels, feedbackFrames);
         
-        float mixL = dryL + wetL * params.mix;
-        float mixR = dryR + wetR * params.mix;
+        for (int i = 0; i < blockSize; ++i) {
+            // The filter coefficients ramp towards the cutoff at the end of
+            // each control period.
+            if ((phase + i) % filterControlRate == 0) {
+                int last = std::min(i + filterControlRate, blockSize) - 1;
+                engine.lowCutFilter.setCutoffFrequency(params.lowCut[last]);
+                engine.highCutFilter.setCutoffFrequency(params.highCut[last]);
+            }
+            
+            const SampleType* wetFrame = wet + i * numChannels;
+            SampleType* frame = feedbackFrames + (i + 1) * numChannels;
+            SampleType feedbackGain = SampleType(params.feedback[i]);
+            for (int channel = 0; channel < numChannels; ++channel) {
+                frame[channel] = wetFrame[channel] * feedbackGain;
+            }
+            engine.lowCutFilter.processFrame(frame);
+            engine.highCutFilter.processFrame(frame);
+        }
         
-        float outL = mixL * params.gain;
-        float outR = mixR * params.gain;
+        if (saturationMode != SaturationMode::off) {
+            saturation.process(feedbackFrames + numChannels, blockSize, params.drive, saturationMode);
+        }
         
-        if (params.bypassed) { 
-            outL = dryL;
-            outR = dryR;
+        // The output hears the delay line at the actual delay time.
+        if (latency > 0) {
+            engine.delayWet(wet, blockSize, numChannels, latency);
         }
         
-        outputDataL[sample] = outL;
-        outputDataR[sample] = outR;
+        std::copy(feedbackFrames + blockSize * numChannels,
+                  feedbackFrames + (blockSize + 1) * numChannels, feedback.begin());
         
-        maxL = std::max(maxL, std::abs(outL));
-        maxR = std::max(maxR, std::abs(outR));
+        if (isMultichannel) {
+            for (int i = 0; i < blockSize; ++i) {
+                const SampleType* frame = feedbackFrames + i * numChannels;
+                SampleType* inputFrame = delayInput + i * numChannels;
+                
+                for (int channel = 0; channel < numChannels; ++channel) {
+                    inputFrame[channel] = inputChannels[channel][offset + i] + frame[channel];
+                }
+            }
+            
+            for (int channel = 0; channel < numChannels; ++channel) {
+                outputChannels[channel] = mainOutput.getWritePointer(channel) + offset;
+            }
+            
+            if (isCrossfading) {
+                for (int channel = 0; channel < numChannels; ++channel) {
+                    juce::FloatVectorOperations::copy(dry + channel * maxBlockSize,
+                                                      outputChannels[channel], blockSize);
+                }
+                
+                // Only the faded output gets measured.
+                SampleType peak = 0;
+                SampleType sumSquares = 0;
+                kernels.mixChannels(outputChannels, numChannels, wet, taps, params.mix, params.gain,
+                                    blockSize, peak, sumSquares);
+                
+                for (int channel = 0; channel < numChannels; ++channel) {
+                    kernels.crossfade(outputChannels[channel], dry + channel * maxBlockSize,
+                                      params.bypass, blockSize, maxL, sumSquaresL);
+                }
+            } else {
+                kernels.mixChannels(outputChannels, numChannels, wet, taps, params.mix, params.gain,
+                                    blockSize, maxL, sumSquaresL);
+            }
+        } else {
+            for (int i = 0; i < blockSize; ++i) {
+                int sample = offset + i;
+                
+                SampleType dryL = inputDataL[sample];
+                SampleType dryR = inputDataR[sample];
+                
+                // convert stereo to mono
+                SampleType mono = (dryL + dryR) * SampleType(0.5);
+                
+                // ping-pong: each channel gets the feedback of the other
+                const SampleType* frame = feedbackFrames + 2*i;
+                delayInput[2*i] = mono*SampleType(params.panL[i]) + frame[1];
+                delayInput[2*i + 1] = mono*SampleType(params.panR[i]) + frame[0];
+            }
+            
+            // The output doesn't feed back into the delay line, so it is mixed
+            // for the whole block at once by a vectorized kernel. This happens in
+            // place: the output channels still hold the dry signal.
+            SampleType* outL = outputDataL + offset;
+            SampleType* outR = isMainOutputStereo ? outputDataR + offset : monoRight;
+            
+            if (!isMainOutputStereo) {
+                juce::FloatVectorOperations::copy(monoRight, outL, blockSize);
+            }
+            
+            if (isCrossfading) {
+                SampleType* dryL = dry;
+                SampleType* dryR = dry + maxBlockSize;
+                juce::FloatVectorOperations::copy(dryL, outL, blockSize);
+                juce::FloatVectorOperations::copy(dryR, outR, blockSize);
+                
+                // Only the faded output gets measured.
+                SampleType peakL = 0;
+                SampleType peakR = 0;
+                SampleType sumL = 0;
+                SampleType sumR = 0;
+                kernels.mixStereo(outL, outR, wet, taps, params.mix, params.gain, blockSize,
+                                  peakL, peakR, sumL, sumR);
+                
+                kernels.crossfade(outL, dryL, params.bypass, blockSize, maxL, sumSquaresL);
+                kernels.crossfade(outR, dryR, params.bypass, blockSize, maxR, sumSquaresR);
+            } else {
+                kernels.mixStereo(outL, outR, wet, taps, params.mix, params.gain, blockSize,
+                                  maxL, maxR, sumSquaresL, sumSquaresR);
+            }
+            
+            // a mono output gets the right channel
+            if (!isMainOutputStereo) {
+                juce::FloatVectorOperations::copy(outL, monoRight, blockSize);
+            }
+        }
+            
+        delayLine.writeBlock(delayInput, blockSize);
     }
     
     #if JUCE_DEBUG
-    protectYourEars(buffer);
+    protectYourEars(buffer, earsWarnings);
     #endif
     
-    levelL.updateIfGreater(maxL);
-    levelR.updateIfGreater(maxR);
+    // The meter has two bars. With more channels, both show the loudest
+    // channel and the RMS over all of them.
+    if (isMultichannel) {
+        maxR = maxL;
+        sumSquaresL /= SampleType(numChannels);
+        sumSquaresR = sumSquaresL;
+    }
+    
+    int numSamples = buffer.getNumSamples();
+    if (numSamples > 0) {
+        LevelRecord record;
+        record.peakL = float(maxL);
+        record.peakR = float(maxR);
+        record.rmsL = float(std::sqrt(sumSquaresL / SampleType(numSamples)));
+        record.rmsR = float(std::sqrt(sumSquaresR / SampleType(numSamples)));
+        record.position = samplePosition;
+        record.numSamples = numSamples;
+        levels.push(record);
+    }
+    samplePosition += numSamples;
+    
+    // Once the input and everything read from the delay line have been
+    // silent for longer than any delay reaches back, all that the delay line
+    // holds within reach is silence, and so is all that the feedback can add.
+    // Processing then stops until there is sound at the input again. The
+    // delay line is cleared on the way, since a longer delay could otherwise
+    // reach past the silence into older audio. The clear is lazy and doesn't
+    // touch the buffer; stale samples read as silence until overwritten.
+    if (isInputSilent && wetPeak <= SampleType(silenceThreshold)) {
+        silentSamples += numSamples;
+    } else {
+        silentSamples = 0;
+    }
+    
+    float reach = std::max(longestDelay, engine.multiTap.getLongestDelayInSamples())
+                + float(DelayLine<SampleType>::maxInterpolationTaps);
+    if (float(silentSamples) > reach) {
+        engine.clear(true);
+        silentSamples = 0;
+        isAsleep = true;
+    }
+}
+
+template<typename SampleType>
+void DelayDSPAudioProcessor::processBypassed(juce::AudioBuffer<SampleType>& buffer,
+                                             [[maybe_unused]] Engine<SampleType>& engine) noexcept
+{
+    // The output is mixed in place, so it already holds the dry signal.
+    // process() has copied it to the right channel of a mono to stereo layout.
+    int numSamples = buffer.getNumSamples();
+    
+   #if DELAYDSP_FEED_DELAY_WHEN_BYPASSED
+    // Only the input goes into the delay line, the feedback loop is stopped.
+    // It is panned the same way as in process(), with the last pan values.
+    auto mainInput = getBusBuffer(buffer, true, 0);
+    auto& delayLine = engine.delayLine;
+    int numChannels = delayLine.getNumChannels();
+    bool isMultichannel = numChannels > 2;
+    
+    const SampleType* inputDataL = mainInput.getReadPointer(0);
+    const SampleType* inputDataR = mainInput.getReadPointer(mainInput.getNumChannels() > 1 ? 1 : 0);
+    SampleType panL = SampleType(params.panL[0]);
+    SampleType panR = SampleType(params.panR[0]);
+    
+    constexpr int maxBlockSize = DelayLine<SampleType>::maxBlockSize;
+    SampleType frames[maxBlockSize * DelayLine<SampleType>::maxChannels];
+    
+    for (int offset = 0; offset < numSamples; offset += maxBlockSize) {
+        int blockSize = std::min(numSamples - offset, maxBlockSize);
+        
+        if (isMultichannel) {
+            for (int channel = 0; channel < numChannels; ++channel) {
+                const SampleType* input = mainInput.getReadPointer(channel) + offset;
+                for (int i = 0; i < blockSize; ++i) {
+                    frames[i * numChannels + channel] = input[i];
+                }
+            }
+        } else {
+            for (int i = 0; i < blockSize; ++i) {
+                SampleType mono = (inputDataL[offset + i] + inputDataR[offset + i]) * SampleType(0.5);
+                frames[2*i] = mono * panL;
+                frames[2*i + 1] = mono * panR;
+            }
+        }
+        
+        delayLine.writeBlock(frames, blockSize);
+    }
+   #endif
+    
+    // No level records are pushed, so the meter falls back to silence.
+    wasBypassed = true;
+    silentSamples = 0;
+    isAsleep = false;
+    samplePosition += numSamples;
+}
+
+template<typename SampleType>
+void DelayDSPAudioProcessor::Engine<SampleType>::readDelayLine(InterpolationQuality quality,
+                                                               const float* delayInSamples,
+                                                               SampleType* wet, SampleType* taps,
+                                                               int numSamples, int gridPhase) noexcept
+{
+    // Pick the interpolator once per block, the read loops themselves are
+    // compiled separately for each of them.
+    switch (quality) {
+        case InterpolationQuality::integer:
+            readDelayLine(delayInSamples, wet, taps, numSamples, gridPhase, noInterpolation);
+            break;
+        case InterpolationQuality::linear:
+            readDelayLine(delayInSamples, wet, taps, numSamples, gridPhase, linearInterpolation);
+            break;
+        case InterpolationQuality::hermite:
+            readDelayLine(delayInSamples, wet, taps, numSamples, gridPhase, hermiteInterpolation);
+            break;
+        case InterpolationQuality::lagrange:
+            readDelayLine(delayInSamples, wet, taps, numSamples, gridPhase, lagrangeInterpolation);
+            break;
+        case InterpolationQuality::allpass:
+            readDelayLine(delayInSamples, wet, taps, numSamples, gridPhase, thiranInterpolation);
+            break;
+        case InterpolationQuality::sinc:
+            readDelayLine(delayInSamples, wet, taps, numSamples, gridPhase, sincInterpolation);
+            break;
+    }
+}
+
+template<typename SampleType>
+void DelayDSPAudioProcessor::Engine<SampleType>::delayWet(SampleType* wet, int numSamples,
+                                                          int numChannels, int latency) noexcept
+{
+    // wetHistory holds the last frames of the previous block. Putting the
+    // new block after them and taking the first numSamples frames delays
+    // the wet signal by the latency.
+    int historySize = latency * numChannels;
+    int blockValues = numSamples * numChannels;
+    SampleType* history = wetHistory.data();
     
+    std::copy(wet, wet + blockValues, history + historySize);
+    std::copy(history, history + blockValues, wet);
+    std::copy(history + blockValues, history + blockValues + historySize, history);
 }
 
+template<typename SampleType>
+template<typename Interpolator>
+void DelayDSPAudioProcessor::Engine<SampleType>::readDelayLine(const float* delayInSamples,
+                                                               SampleType* wet, SampleType* taps,
+                                                               int numSamples, int gridPhase,
+                                                               Interpolator& interpolator) noexcept
+{
+    delayLine.readBlock(delayInSamples, wet, numSamples, interpolator);
+    
+    std::fill(taps, taps + numSamples * delayLine.getNumChannels(), SampleType(0));
+    multiTap.process(delayLine, taps, numSamples, gridPhase, interpolator);
+}
 
 //==============================================================================
 bool DelayDSPAudioProcessor::hasEditor() const
@@ -260,7 +704,7 @@ juce::AudioProcessorEditor* DelayDSPAudioProcessor::createEditor()
 void DelayDSPAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
     copyXmlToBinary(*apvts.copyState().createXml(), destData);
-
+    
     //DBG(apvts.copyState().toXmlString());
 }
 
@@ -12,7 +12,20 @@
 #include "Parameters.h"
 #include "Tempo.h"
 #include "DelayLine.h"
+#include "MultiTap.h"
+#include "StateVariableFilter.h"
 #include "Measurement.h"
+#include "LoadMeasurement.h"
+#include "FeedbackSaturation.h"
+#include "ProtectYourEars.h"
+
+// Keep writing the input into the delay line while the plug-in is bypassed,
+// so that turning the bypass off again picks up the echoes of what was
+// played in the meantime. Without it a bypassed instance does no work at
+// all, and the delay line starts out silent when the bypass is turned off.
+#ifndef DELAYDSP_FEED_DELAY_WHEN_BYPASSED
+ #define DELAYDSP_FEED_DELAY_WHEN_BYPASSED 0
+#endif
 
 //==============================================================================
 /**
@@ -23,7 +36,7 @@ public:
     //==============================================================================
     DelayDSPAudioProcessor();
     ~DelayDSPAudioProcessor() override;
-
+    
     //==============================================================================
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
@@ -33,26 +46,32 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    
+    bool supportsDoublePrecisionProcessing() const override
+    {
+        return true;
+    }
+    
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
-
+    
     //==============================================================================
     const juce::String getName() const override;
-
+    
     bool acceptsMidi() const override;
     bool producesMidi() const override;
     bool isMidiEffect() const override;
     double getTailLengthSeconds() const override;
-
+    
     //==============================================================================
     int getNumPrograms() override;
     int getCurrentProgram() override;
     void setCurrentProgram (int index) override;
     const juce::String getProgramName (int index) override;
     void changeProgramName (int index, const juce::String& newName) override;
-
+    
     //==============================================================================
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
@@ -61,28 +80,108 @@ public:
     juce::AudioProcessorValueTreeState apvts {
         *this, nullptr, "Parameters", Parameters::createParameterLayout()
     };
-
+    
     juce::AudioProcessorParameter* getBypassParameter() const override;
     
     Parameters params;
     
-    Measurement levelL, levelR;
+    // Output levels of every block, drained by the editor.
+    Measurement levels;
+    
+    // DSP load of this instance, readable from any thread.
+    LoadMeasurement load;
 
 
 private:
+    // Everything that holds samples, once for each precision the host can
+    // ask for. Only the engine of the current precision gets prepared, so
+    // the other one doesn't allocate a delay line.
+    template<typename SampleType>
+    struct Engine
+    {
+        void prepare(double sampleRate, int maxDelayInSamples, int numChannels,
+                     DelayLineStorage storage, SaturationMode saturationMode, MemoryArena& memory);
+        
+        // Silences the feedback loop, and the delay line too if asked. This
+        // doesn't touch the delay line's buffer, so it is real-time safe.
+        void clear(bool clearDelayLine) noexcept;
+        
+        // gridPhase is where the block starts within the sub-block grid.
+        void readDelayLine(InterpolationQuality quality, const float* delayInSamples,
+                           SampleType* wet, SampleType* taps, int numSamples, int gridPhase) noexcept;
+        
+        template<typename Interpolator>
+        void readDelayLine(const float* delayInSamples, SampleType* wet, SampleType* taps,
+                           int numSamples, int gridPhase, Interpolator& interpolator) noexcept;
+        
+        void delayWet(SampleType* wet, int numSamples, int numChannels, int latency) noexcept;
+        
+        DelayLine<SampleType> delayLine;
+        
+        NoInterpolation<SampleType> noInterpolation;
+        LinearInterpolation<SampleType> linearInterpolation;
+        HermiteInterpolation<SampleType> hermiteInterpolation;
+        LagrangeInterpolation<SampleType> lagrangeInterpolation;
+        ThiranInterpolation<SampleType> thiranInterpolation;
+        SincInterpolation<SampleType> sincInterpolation;
+        
+        MultiTap<SampleType> multiTap;
+        
+        // Filtered feedback of the previous sample, one per delay line channel.
+        std::array<SampleType, DelayLine<SampleType>::maxChannels> feedback {};
+        
+        StateVariableFilter<SampleType> lowCutFilter;
+        StateVariableFilter<SampleType> highCutFilter;
+        
+        FeedbackSaturation<SampleType> saturation;
+        SaturationMode currentSaturationMode = SaturationMode::off;
+        
+        // the end of the previous block of the wet signal, see delayWet()
+        std::array<SampleType, (FeedbackSaturation<SampleType>::maxLatency
+                                + DelayLine<SampleType>::maxBlockSize)
+                               * DelayLine<SampleType>::maxChannels> wetHistory {};
+    };
+    
+    template<typename SampleType>
+    void process(juce::AudioBuffer<SampleType>& buffer, Engine<SampleType>& engine) noexcept;
+    
+    template<typename SampleType>
+    void processBypassed(juce::AudioBuffer<SampleType>& buffer, Engine<SampleType>& engine) noexcept;
+    
     Tempo tempo;
     
-    DelayLine delayLineL, delayLineR;
+    // Pre-faulted memory for the delay line of the engine in use.
+    MemoryArena delayMemory;
     
-    float feedbackL = 0.0f;
-    float feedbackR = 0.0f;
+    Engine<float> floatEngine;
+    Engine<double> doubleEngine;
     
-    juce::dsp::StateVariableTPTFilter<float> lowCutFilter;
-    juce::dsp::StateVariableTPTFilter<float> highCutFilter;
+    // How often the feedback filters get new coefficients, in samples.
+    static constexpr int filterControlRate = 16;
     
-    float lastLowCut = -1.0f;
-    float lastHighCut = -1.0f;
-
+    // Position of the next block since prepareToPlay, for the level records.
+    juce::int64 samplePosition = 0;
+    
+    // Set while processBypassed() takes over, so the engine can be cleared
+    // of its stale state when the bypass is turned off.
+    bool wasBypassed = false;
+    
+    // Below this level, about -90 dB, the input and the echoes count as
+    // silent, for the tail length and for falling asleep.
+    static constexpr float silenceThreshold = 3.1623e-5f;
+    
+    // How long both the input and the delay line output have been silent,
+    // and whether processing has stopped because of it. See process().
+    juce::int64 silentSamples = 0;
+    bool isAsleep = false;
+    
+    // The tempo of the last block, for getTailLengthSeconds().
+    std::atomic<double> hostTempo = 120.0;
+    
+   #if JUCE_DEBUG
+    // Filled in by protectYourEars() on the audio thread.
+    EarsWarnings earsWarnings;
+   #endif
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayDSPAudioProcessor)
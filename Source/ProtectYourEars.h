@@ -2,32 +2,73 @@
 
 #include <JuceHeader.h>
 
+// What protectYourEars() found, printed from the message thread. The check
+// itself runs on the audio thread, where DBG would allocate and write to
+// stderr, so it only sets flags here.
+class EarsWarnings : private juce::Timer
+{
+public:
+    enum Flags { nan = 1, inf = 2, screaming = 4, outOfRange = 8 };
+    
+    EarsWarnings() { startTimerHz(4); }
+    ~EarsWarnings() override { stopTimer(); }
+    
+    void report(int flag, float value = 0.0f) noexcept
+    {
+        if (flag == outOfRange) {
+            outOfRangeValue.store(value, std::memory_order_relaxed);
+        }
+        flags.fetch_or(flag, std::memory_order_release);
+    }
+
+private:
+    void timerCallback() override
+    {
+        int found = flags.exchange(0, std::memory_order_acquire);
+        if (found & nan) {
+            DBG("!!! WARNING: nan detected in audio buffer, silencing !!!");
+        }
+        if (found & inf) {
+            DBG("!!! WARNING: inf detected in audio buffer, silencing !!!");
+        }
+        if (found & screaming) {
+            DBG("!!! WARNING: sample out of range, silencing !!!");
+        }
+        if (found & outOfRange) {
+            [[maybe_unused]] float value = outOfRangeValue.load(std::memory_order_relaxed);
+            DBG("!!! WARNING: sample out of range: " << value << " !!!");
+        }
+    }
+    
+    std::atomic<int> flags { 0 };
+    std::atomic<float> outOfRangeValue { 0.0f };
+};
+
 // Silences the buffer if bad or loud values are detected in the output buffer.
 // Use this during debugging to avoid blowing out your eardrums on headphones.
-inline void protectYourEars(juce::AudioBuffer<float>& buffer)
+template<typename SampleType>
+void protectYourEars(juce::AudioBuffer<SampleType>& buffer, EarsWarnings& warnings) noexcept
 {
     bool firstWarning = true;
     for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
-        float* channelData = buffer.getWritePointer(channel);
+        SampleType* channelData = buffer.getWritePointer(channel);
         for (int sample = 0; sample < buffer.getNumSamples(); ++sample) {
-            float x = channelData[sample];
-            bool silence = false;
+            SampleType x = channelData[sample];
+            int silence = 0;
             if (std::isnan(x)) {
-                DBG("!!! WARNING: nan detected in audio buffer, silencing !!!");
-                silence = true;
+                silence = EarsWarnings::nan;
             } else if (std::isinf(x)) {
-                DBG("!!! WARNING: inf detected in audio buffer, silencing !!!");
-                silence = true;
-            } else if (x < -2.0f || x > 2.0f) {  // screaming feedback
-                DBG("!!! WARNING: sample out of range, silencing !!!");
-                silence = true;
-            } else if (x < -1.0f || x > 1.0f) {
+                silence = EarsWarnings::inf;
+            } else if (x < SampleType(-2) || x > SampleType(2)) {  // screaming feedback
+                silence = EarsWarnings::screaming;
+            } else if (x < SampleType(-1) || x > SampleType(1)) {
                 if (firstWarning) {
-                    DBG("!!! WARNING: sample out of range: " << x << " !!!");
+                    warnings.report(EarsWarnings::outOfRange, float(x));
                     firstWarning = false;
                 }
             }
-            if (silence) {
+            if (silence != 0) {
+                warnings.report(silence);
                 buffer.clear();
                 return;
             }
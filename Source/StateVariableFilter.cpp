@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    StateVariableFilter.cpp
+    Created: 17 Oct 2026 4:41:08pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#include "StateVariableFilter.h"
+
+template<typename SampleType>
+void StateVariableFilter<SampleType>::setControlRate(int numSamples) noexcept
+{
+    jassert(numSamples > 0);
+    controlRate = numSamples;
+}
+
+template<typename SampleType>
+void StateVariableFilter<SampleType>::prepare(double sampleRate, int numChannels)
+{
+    s1.resize(size_t(numChannels));
+    s2.resize(size_t(numChannels));
+    
+    // The table is spaced logarithmically between 20 Hz and 20 kHz. Cutoff
+    // frequencies above Nyquist are not allowed, so clamp them just below.
+    double octaves = std::log2(double(maxFrequency / minFrequency));
+    double nyquist = sampleRate * 0.49;
+    tableScale = float(tableSize / octaves);
+    
+    for (size_t i = 0; i <= tableSize; ++i) {
+        double frequency = minFrequency * std::exp2(octaves * double(i) / tableSize);
+        frequency = std::min(frequency, nyquist);
+        
+        double tableG = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        gTable[i] = SampleType(tableG);
+        hTable[i] = SampleType(1.0 / (1.0 + double(R2) * tableG + tableG * tableG));
+    }
+    
+    reset();
+}
+
+template<typename SampleType>
+void StateVariableFilter<SampleType>::reset() noexcept
+{
+    std::fill(s1.begin(), s1.end(), SampleType(0));
+    std::fill(s2.begin(), s2.end(), SampleType(0));
+    
+    // The first cutoff after a reset is applied without ramping.
+    cutoff = -1.0f;
+    snapToCutoff = true;
+}
+
+template<typename SampleType>
+void StateVariableFilter<SampleType>::setCutoffFrequency(float newCutoff) noexcept
+{
+    if (newCutoff == cutoff) { return; }
+    cutoff = newCutoff;
+    
+    SampleType newG, newH;
+    lookup(cutoff, newG, newH);
+    
+    if (snapToCutoff) {
+        g = newG;
+        h = newH;
+        rampSamples = 0;
+        snapToCutoff = false;
+    } else {
+        gStep = (newG - g) / SampleType(controlRate);
+        hStep = (newH - h) / SampleType(controlRate);
+        rampSamples = controlRate;
+    }
+}
+
+template<typename SampleType>
+void StateVariableFilter<SampleType>::lookup(float frequency, SampleType& newG,
+                                             SampleType& newH) const noexcept
+{
+    float position = std::log2(frequency / minFrequency) * tableScale;
+    position = std::clamp(position, 0.0f, float(tableSize));
+    
+    int index = std::min(int(position), tableSize - 1);
+    SampleType t = SampleType(position - float(index));
+    
+    newG = gTable[size_t(index)] + (gTable[size_t(index + 1)] - gTable[size_t(index)]) * t;
+    newH = hTable[size_t(index)] + (hTable[size_t(index + 1)] - hTable[size_t(index)]) * t;
+}
+
+template class StateVariableFilter<float>;
+template class StateVariableFilter<double>;
@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    StateVariableFilter.h
+    Created: 17 Oct 2026 4:41:08pm
+    Author:  Johan Bremin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// TPT state variable filter, like juce::dsp::StateVariableTPTFilter, but the
+// coefficients are updated at control rate. The cutoff is looked up in a
+// table that is built in prepare(), and the coefficients ramp linearly to
+// the new value over one control period, so no tan() is needed while the
+// cutoff is being automated.
+//
+// The cutoff is always float. The coefficients and the state use SampleType,
+// so that the double precision path keeps its headroom in the feedback loop.
+template<typename SampleType>
+class StateVariableFilter
+{
+public:
+    enum class Type
+    {
+        lowpass,
+        highpass,
+    };
+    
+    void setType(Type newType) noexcept
+    {
+        type = newType;
+    }
+    
+    // Number of samples over which the coefficients ramp to a new cutoff.
+    // Set this to how often setCutoffFrequency() gets called.
+    void setControlRate(int numSamples) noexcept;
+    
+    void prepare(double sampleRate, int numChannels);
+    void reset() noexcept;
+    
+    void setCutoffFrequency(float newCutoff) noexcept;
+    
+    // Filters one sample for every channel, in place.
+    void processFrame(SampleType* frame) noexcept
+    {
+        if (rampSamples > 0) {
+            g += gStep;
+            h += hStep;
+            rampSamples -= 1;
+        }
+        
+        for (size_t channel = 0; channel < s1.size(); ++channel) {
+            SampleType yHP = h * (frame[channel] - s1[channel] * (g + R2) - s2[channel]);
+            SampleType yBP = yHP * g + s1[channel];
+            s1[channel] = yHP * g + yBP;
+            SampleType yLP = yBP * g + s2[channel];
+            s2[channel] = yBP * g + yLP;
+            
+            frame[channel] = (type == Type::lowpass) ? yLP : yHP;
+        }
+    }
+    
+private:
+    static constexpr float minFrequency = 20.0f;
+    static constexpr float maxFrequency = 20000.0f;
+    static constexpr int tableSize = 512;
+    
+    // Q of 1/sqrt(2), the same default as the JUCE filter.
+    static constexpr SampleType R2 = juce::MathConstants<SampleType>::sqrt2;
+    
+    void lookup(float cutoff, SampleType& newG, SampleType& newH) const noexcept;
+    
+    Type type = Type::lowpass;
+    
+    std::array<SampleType, tableSize + 1> gTable {};
+    std::array<SampleType, tableSize + 1> hTable {};
+    float tableScale = 0.0f;
+    
+    int controlRate = 1;
+    float cutoff = -1.0f;
+    bool snapToCutoff = true;
+    
+    SampleType g = 0;
+    SampleType h = 0;
+    SampleType gStep = 0;
+    SampleType hStep = 0;
+    int rampSamples = 0;
+    
+    std::vector<SampleType> s1, s2;
+};
@@ -10,7 +10,7 @@
 
 #include "Tempo.h"
 
-static std::array<double, 16> noteLengthMultipliers =
+static constexpr std::array<double, Tempo::numNoteLengths> noteLengthMultipliers =
 {
     0.125,
     0.5 / 3.0,
@@ -30,29 +30,94 @@ static std::array<double, 16> noteLengthMultipliers =
     4.0,
 };
 
+void Tempo::prepare(double newSampleRate) noexcept
+{
+    sampleRate = newSampleRate;
+    reset();
+}
+
 void Tempo::reset() noexcept
 {
     bpm = 120.0;
+    rampStartBpm = bpm;
+    rampEndBpm = bpm;
+    lastBpm = bpm;
+    lastNumSamples = 0;
+    expectedTimeInSamples = -1;
+    
+    updateNoteLengths(bpm, bpm, 1);
 }
 
-void Tempo::update(const juce::AudioPlayHead* playhead) noexcept
+void Tempo::update(const juce::AudioPlayHead* playhead, int numSamples) noexcept
 {
-    reset();
+    double newBpm = 120.0;
+    bool isContinuous = false;
+    juce::int64 timeInSamples = -1;
     
-    if (playhead == nullptr) { return; }
+    if (playhead != nullptr) {
+        if (const auto opt = playhead->getPosition(); opt.hasValue()) {
+            const auto& pos = *opt;
+            
+            if (pos.getBpm().hasValue()) {
+                newBpm = *pos.getBpm();
+            }
+            
+            // A loop or a jump resets the prediction, as does a host that
+            // doesn't report its position.
+            if (pos.getIsPlaying() && pos.getTimeInSamples().hasValue()) {
+                timeInSamples = *pos.getTimeInSamples();
+                isContinuous = timeInSamples == expectedTimeInSamples;
+            }
+        }
+    }
     
-    const auto opt = playhead->getPosition();
+    double startBpm = newBpm;
+    double endBpm = newBpm;
     
-    if (!opt.hasValue()) { return; }
+    // Carry on from where the previous ramp ended, towards the tempo the
+    // host will probably report at the start of the next block. The limits
+    // keep a wild prediction from a very long block in check.
+    if (isContinuous) {
+        startBpm = rampEndBpm;
+        if (lastNumSamples > 0) {
+            double slope = (newBpm - lastBpm) / double(lastNumSamples);
+            endBpm = std::clamp(newBpm + slope * double(numSamples), newBpm * 0.5, newBpm * 2.0);
+        }
+    }
     
-    const auto& pos = *opt;
+    bpm = newBpm;
+    lastBpm = newBpm;
+    lastNumSamples = numSamples;
+    expectedTimeInSamples = timeInSamples >= 0 ? timeInSamples + numSamples : -1;
     
-    if (pos.getBpm().hasValue()) {
-        bpm = *pos.getBpm();
+    if (startBpm != rampStartBpm || endBpm != rampEndBpm) {
+        updateNoteLengths(startBpm, endBpm, std::max(numSamples, 1));
+    }
+}
+
+void Tempo::updateNoteLengths(double startBpm, double endBpm, int numSamples) noexcept
+{
+    rampStartBpm = startBpm;
+    rampEndBpm = endBpm;
+    
+    // The beat length is ramped linearly rather than the tempo. Over a
+    // single block the difference is far below a sample.
+    double startBeat = 60.0 * sampleRate / startBpm;
+    double endBeat = 60.0 * sampleRate / endBpm;
+    double step = (endBeat - startBeat) / double(numSamples);
+    
+    for (size_t i = 0; i < noteLengthMultipliers.size(); ++i) {
+        noteLengthSamples[i] = noteLengthMultipliers[i] * startBeat;
+        noteLengthStep[i] = noteLengthMultipliers[i] * step;
     }
 }
 
 double Tempo::getMillisecondsForNoteLength(int index) const noexcept
 {
-    return 60000.0 * noteLengthMultipliers[size_t(index)] / bpm;
+    return getMillisecondsForNoteLength(index, bpm);
+}
+
+double Tempo::getMillisecondsForNoteLength(int index, double beatsPerMinute) noexcept
+{
+    return 60000.0 * noteLengthMultipliers[size_t(index)] / beatsPerMinute;
 }
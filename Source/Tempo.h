@@ -12,20 +12,61 @@
 
 #include <JuceHeader.h>
 
+// Follows the tempo of the host. The play head is only read at the start of
+// every block, so a tempo ramp would otherwise move in steps. While the
+// transport runs without jumps, the change in tempo since the previous block
+// is assumed to carry on, and the tempo ramps towards that prediction over
+// the block. The ramp starts where the previous one ended, so the synced
+// delay time never jumps, and a wrong prediction is corrected in the next
+// block.
+//
+// The note lengths in samples and their change per sample are stored for
+// all the notes at once, only when the tempo changes, so the audio loop can
+// read them without any divisions.
 class Tempo
 {
 public:
+    void prepare(double sampleRate) noexcept;
     void reset() noexcept;
     
-    void update(const juce::AudioPlayHead* playhead) noexcept;
+    void update(const juce::AudioPlayHead* playhead, int numSamples) noexcept;
     
+    // Uses the tempo at the start of the block.
     double getMillisecondsForNoteLength(int index) const noexcept;
     
+    static double getMillisecondsForNoteLength(int index, double beatsPerMinute) noexcept;
+    
+    // Length of the note at a sample offset into the current block.
+    double getSamplesForNoteLength(int index, int offset) const noexcept
+    {
+        return noteLengthSamples[size_t(index)] + noteLengthStep[size_t(index)] * double(offset);
+    }
+    
     double getTempo() const noexcept
     {
         return bpm;
     }
     
+    static constexpr int numNoteLengths = 16;
+    
 private:
+    void updateNoteLengths(double startBpm, double endBpm, int numSamples) noexcept;
+    
+    double sampleRate = 44100.0;
+    
+    // reported by the host at the start of the block
     double bpm = 120.0;
+    
+    // the tempo at the start of the current block and at its end
+    double rampStartBpm = 120.0;
+    double rampEndBpm = 120.0;
+    
+    // What the host reported for the previous block, to see if the transport
+    // moved on without jumping and how fast the tempo is changing.
+    double lastBpm = 120.0;
+    int lastNumSamples = 0;
+    juce::int64 expectedTimeInSamples = -1;
+    
+    std::array<double, numNoteLengths> noteLengthSamples {};
+    std::array<double, numNoteLengths> noteLengthStep {};
 };
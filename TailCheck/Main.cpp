@@ -0,0 +1,170 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 10:12:48pm
+    Author:  Johan Bremin
+
+    Renders the decay of an impulse for a few delay and feedback settings,
+    and checks that the tail the processor reports covers every sample of
+    it above -90 dB, without running on much longer than that. Also checks
+    that a mono to stereo instance keeps both outputs going once it sleeps.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+
+struct TailCase
+{
+    float delayTime;   // milliseconds
+    float feedback;    // percent
+    float tapTime;     // milliseconds, or 0 with multi-tap off
+};
+
+static void setParameter(DelayDSPAudioProcessor& processor, const juce::ParameterID& id, float value)
+{
+    auto* parameter = processor.apvts.getParameter(id.getParamID());
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+// Seconds from the end of the impulse to the last output sample at or
+// above the threshold, with the latency taken out.
+static double renderDecay(DelayDSPAudioProcessor& processor, double sampleRate, int blockSize,
+                          double renderSeconds, float threshold)
+{
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+    
+    juce::int64 numSamples = juce::int64(renderSeconds * sampleRate);
+    juce::int64 lastAudible = -1;
+    
+    for (juce::int64 position = 0; position < numSamples; position += blockSize) {
+        buffer.clear();
+        if (position == 0) {
+            buffer.setSample(0, 0, 1.0f);
+            buffer.setSample(1, 0, 1.0f);
+        }
+        
+        processor.processBlock(buffer, midi);
+        
+        for (int i = 0; i < blockSize; ++i) {
+            if (std::abs(buffer.getSample(0, i)) >= threshold || std::abs(buffer.getSample(1, i)) >= threshold) {
+                lastAudible = position + i;
+            }
+        }
+    }
+    return double(lastAudible - processor.getLatencySamples()) / sampleRate;
+}
+
+// Plays an impulse followed by a quiet signal, below the threshold, into a
+// mono to stereo instance. Once the echoes have died out the instance falls
+// asleep, and the quiet signal should pass through on both outputs.
+static bool checkMonoToStereoAsleep(double sampleRate, int blockSize, float threshold)
+{
+    DelayDSPAudioProcessor processor;
+    processor.setBusesLayout({ { juce::AudioChannelSet::mono() }, { juce::AudioChannelSet::stereo() } });
+    
+    setParameter(processor, delayTimeParamID, 80.0f);
+    setParameter(processor, feedbackParamID, 0.0f);
+    setParameter(processor, mixParamID, 100.0f);
+    
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+    
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+    float quiet = threshold * 0.5f;
+    
+    for (juce::int64 position = 0; position < juce::int64(sampleRate); position += blockSize) {
+        buffer.clear();
+        juce::FloatVectorOperations::fill(buffer.getWritePointer(0), quiet, blockSize);
+        if (position == 0) {
+            buffer.setSample(0, 0, 1.0f);
+        }
+        processor.processBlock(buffer, midi);
+    }
+    
+    processor.releaseResources();
+    
+    bool passesThrough = true;
+    for (int i = 0; i < blockSize; ++i) {
+        passesThrough &= std::abs(buffer.getSample(0, i) - quiet) < 1.0e-9f
+                      && std::abs(buffer.getSample(1, i) - quiet) < 1.0e-9f;
+    }
+    
+    std::cout << "mono to stereo, asleep: " << (passesThrough ? "passes through" : "the right channel is wrong")
+              << std::endl;
+    return passesThrough;
+}
+
+int main (int, char*[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    const double sampleRate = 48000.0;
+    const int blockSize = 256;
+    const float threshold = juce::Decibels::decibelsToGain(-90.0f);
+    
+    const TailCase cases[] = {
+        { 80.0f, 0.0f, 0.0f },
+        { 80.0f, 50.0f, 0.0f },
+        { 80.0f, -70.0f, 0.0f },
+        { 333.0f, 37.0f, 0.0f },
+        { 333.0f, 90.0f, 0.0f },
+        { 1000.0f, -25.0f, 0.0f },
+        { 80.0f, 0.0f, 500.0f },
+        { 80.0f, 60.0f, 500.0f },
+    };
+    
+    int numFailures = 0;
+    
+    for (const auto& tailCase : cases) {
+        DelayDSPAudioProcessor processor;
+        processor.setBusesLayout({ { juce::AudioChannelSet::stereo() }, { juce::AudioChannelSet::stereo() } });
+        
+        setParameter(processor, delayTimeParamID, tailCase.delayTime);
+        setParameter(processor, feedbackParamID, tailCase.feedback);
+        setParameter(processor, mixParamID, 100.0f);
+        
+        // A single tap, longer than the main delay, which the feedback
+        // repeats along with the main delay.
+        if (tailCase.tapTime > 0.0f) {
+            setParameter(processor, multiTapParamID, 1.0f);
+            setParameter(processor, tapParamID(0, "Time"), tailCase.tapTime);
+            setParameter(processor, tapParamID(0, "Level"), 100.0f);
+        }
+        
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+        
+        double reported = processor.getTailLengthSeconds();
+        double delay = double(tailCase.delayTime) / 1000.0;
+        double rendered = renderDecay(processor, sampleRate, blockSize, reported + 2.0 * delay + 0.5, threshold);
+        
+        processor.releaseResources();
+        
+        // The echoes are panned and filtered on every repeat, so the rendered
+        // decay may end a repeat or so before the reported tail, never after.
+        bool tooShort = rendered > reported;
+        bool tooLong = reported - rendered > 2.0 * delay;
+        
+        std::cout << "delay " << tailCase.delayTime << " ms, feedback " << tailCase.feedback
+                  << "%, tap " << tailCase.tapTime << " ms: reported " << reported << " s, rendered " << rendered << " s";
+        if (tooShort) {
+            std::cout << " - the reported tail is too short";
+        } else if (tooLong) {
+            std::cout << " - the reported tail is too long";
+        }
+        std::cout << std::endl;
+        
+        numFailures += (tooShort || tooLong) ? 1 : 0;
+    }
+    
+    if (!checkMonoToStereoAsleep(sampleRate, blockSize, threshold)) {
+        numFailures += 1;
+    }
+    
+    return numFailures == 0 ? 0 : 1;
+}
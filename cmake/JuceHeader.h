@@ -0,0 +1,22 @@
+/*
+
+    The CMake build's stand-in for the JuceHeader.h that the Projucer
+    generates into JuceLibraryCode. It includes the same JUCE modules that
+    DelayDSPCore is built with, plus the binary resources.
+
+*/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_core/juce_core.h>
+#include <juce_data_structures/juce_data_structures.h>
+#include <juce_dsp/juce_dsp.h>
+#include <juce_events/juce_events.h>
+#include <juce_graphics/juce_graphics.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <juce_gui_extra/juce_gui_extra.h>
+
+#include "BinaryData.h"